@@ -0,0 +1,212 @@
+/*
+File: benchmarkFractionCalculator
+Author: Logan Copeland
+Description: Benchmarks for the Fraction hot paths, prints one CSV row per benchmark and data set
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "fractionCalculator.h"
+
+using namespace std;
+
+// inputs for one data set
+template <typename T>
+struct Dataset {
+    string name;
+    bool fits = true; // every sum, product and quotient of neighbours fits in T
+    vector<T> nums; // unreduced numerators for construction
+    vector<T> denoms; // unreduced denominators for construction
+    vector<Fraction<T>> fractions; // normalized values with non-zero numerators
+    string text; // fractions formatted as whitespace separated "x/y" tokens
+};
+
+// keeps a computed value alive so the compiler cannot drop the work that produced it
+template <typename V>
+inline void keep(const V &value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// builds the normalized fractions and their text from nums and denoms
+template <typename T>
+void finishDataset(Dataset<T> &dataset) {
+    ostringstream out;
+    for (size_t i = 0; i < dataset.nums.size(); i++) {
+        dataset.fractions.push_back(Fraction<T>(dataset.nums[i], dataset.denoms[i]));
+        out << dataset.fractions.back() << '\n';
+    }
+    dataset.text = out.str();
+}
+
+// random values with magnitude in [1, limit] and random signs on the numerators
+template <typename T>
+Dataset<T> randomDataset(const string &name, size_t size, T limit, bool fits, mt19937_64 &random) {
+    uniform_int_distribution<T> values(1, limit);
+    Dataset<T> dataset;
+    dataset.name = name;
+    dataset.fits = fits;
+    for (size_t i = 0; i < size; i++) {
+        T num = values(random);
+        dataset.nums.push_back((random() & 1) ? -num : num);
+        dataset.denoms.push_back(values(random));
+    }
+    finishDataset(dataset);
+    return dataset;
+}
+
+// ratios of consecutive Fibonacci numbers, the slowest case for Euclid's algorithm
+template <typename T>
+Dataset<T> fibonacciDataset(const string &name, size_t size, int maxIndex) {
+    vector<T> fibonacci = {1, 1};
+    while (int(fibonacci.size()) <= maxIndex + 1) {
+        fibonacci.push_back(fibonacci[fibonacci.size() - 1] + fibonacci[fibonacci.size() - 2]);
+    }
+
+    Dataset<T> dataset;
+    dataset.name = name;
+    for (size_t i = 0; i < size; i++) {
+        int index = maxIndex - int(i % 16);
+        dataset.nums.push_back(fibonacci[index]);
+        dataset.denoms.push_back(fibonacci[index + 1]);
+    }
+    finishDataset(dataset);
+    return dataset;
+}
+
+// runs body over every element repetitions times and prints the fastest repetition
+template <typename Body>
+void run(const string &benchmark, const string &dataset, size_t operations, int repetitions, Body body) {
+    double best = 0;
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        auto start = chrono::steady_clock::now();
+        body();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if ((repetition == 0) || (seconds < best)) {
+            best = seconds;
+        }
+    }
+
+    double nsPerOp = best * 1e9 / operations;
+    cout << benchmark << ',' << dataset << ',' << operations << ',' << nsPerOp << ',' << (operations / best / 1e6) << '\n';
+}
+
+template <typename T>
+void benchmarkDataset(const Dataset<T> &data, int repetitions) {
+    const vector<Fraction<T>> &fractions = data.fractions;
+    size_t size = fractions.size();
+
+    run("construct", data.name, size, repetitions, [&]() {
+        for (size_t i = 0; i < size; i++) {
+            keep(Fraction<T>(data.nums[i], data.denoms[i]));
+        }
+    });
+
+    // binary operators pair each fraction with its neighbour. When the results do not fit in T the
+    // non-throwing forms are timed instead, they do all of the wide arithmetic before the range check.
+    run("add", data.name, size - 1, repetitions, [&]() {
+        for (size_t i = 0; i + 1 < size; i++) {
+            if (data.fits) {
+                keep(fractions[i] + fractions[i + 1]);
+            } else {
+                keep(tryAdd(fractions[i], fractions[i + 1]));
+            }
+        }
+    });
+
+    run("multiply", data.name, size - 1, repetitions, [&]() {
+        for (size_t i = 0; i + 1 < size; i++) {
+            if (data.fits) {
+                keep(fractions[i] * fractions[i + 1]);
+            } else {
+                keep(tryMultiply(fractions[i], fractions[i + 1]));
+            }
+        }
+    });
+
+    run("divide", data.name, size - 1, repetitions, [&]() {
+        for (size_t i = 0; i + 1 < size; i++) {
+            if (data.fits) {
+                keep(fractions[i] / fractions[i + 1]);
+            } else {
+                keep(tryDivide(fractions[i], fractions[i + 1]));
+            }
+        }
+    });
+
+    if (data.fits) {
+        run("add_assign", data.name, size - 1, repetitions, [&]() {
+            for (size_t i = 0; i + 1 < size; i++) {
+                Fraction<T> sum = fractions[i];
+                sum += fractions[i + 1];
+                keep(sum);
+            }
+        });
+    }
+
+    run("less", data.name, size - 1, repetitions, [&]() {
+        for (size_t i = 0; i + 1 < size; i++) {
+            keep(fractions[i] < fractions[i + 1]);
+        }
+    });
+
+    run("equal", data.name, size - 1, repetitions, [&]() {
+        for (size_t i = 0; i + 1 < size; i++) {
+            keep(fractions[i] == fractions[i + 1]);
+        }
+    });
+
+    // the stream operators only accept non-negative input, so parse the magnitudes
+    string positiveText;
+    for (char character : data.text) {
+        if (character != '-') {
+            positiveText += character;
+        }
+    }
+    run("parse", data.name, size, repetitions, [&]() {
+        istringstream in(positiveText);
+        Fraction<T> fraction;
+        for (size_t i = 0; i < size; i++) {
+            in >> fraction;
+            keep(fraction);
+        }
+    });
+
+    run("format", data.name, size, repetitions, [&]() {
+        ostringstream out;
+        for (size_t i = 0; i < size; i++) {
+            out << fractions[i] << '\n';
+        }
+        keep(out.tellp());
+    });
+}
+
+int main(int argc, char *argv[]) {
+    // optional arguments: number of fractions per data set and number of timed repetitions
+    size_t size = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1000000;
+    int repetitions = (argc > 2) ? atoi(argv[2]) : 5;
+    if ((size < 2) || (repetitions < 1)) {
+        cerr << "usage: " << argv[0] << " [fractions >= 2] [repetitions >= 1]" << endl;
+        return 1;
+    }
+
+    // a fixed seed so that every run and every version sees the same inputs
+    mt19937_64 random(2024);
+
+    cout << "benchmark,dataset,operations,ns_per_op,mops_per_s\n";
+    benchmarkDataset(randomDataset<int32_t>("small_int32", size, 1000, true, random), repetitions);
+    benchmarkDataset(randomDataset<int64_t>("medium_int64", size, int64_t(1) << 30, true, random), repetitions);
+
+    // operands close to the top of int64_t, so the cross products and GCDs use the full 128 bits
+    benchmarkDataset(randomDataset<int64_t>("large_int64", size, int64_t(1) << 62, false, random), repetitions);
+    benchmarkDataset(fibonacciDataset<int64_t>("fibonacci_int64", size, 43), repetitions);
+    cout << flush;
+
+    return 0;
+}
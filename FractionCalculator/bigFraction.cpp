@@ -0,0 +1,619 @@
+/*
+File: bigFraction.cpp
+Author: Logan Copeland
+Description: Arbitrary precision fraction class implementation file
+*/
+
+#include "bigFraction.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+// limb pool:
+
+static const size_t minBlockShift = 4; // smallest pooled block is 16 bytes
+static const size_t numSizeClasses = 12; // largest pooled block is 32 KiB
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+struct LimbPool {
+    FreeBlock *freeLists[numSizeClasses] = {};
+
+    ~LimbPool() {
+        for (size_t i = 0; i < numSizeClasses; i++) {
+            while (freeLists[i] != nullptr) {
+                FreeBlock *block = freeLists[i];
+                freeLists[i] = block->next;
+                free(block);
+            }
+        }
+        destroyed = true;
+    }
+
+    static thread_local bool destroyed; // blocks released after thread exit go straight back to free()
+};
+
+thread_local bool LimbPool::destroyed = false;
+static thread_local LimbPool limbPool;
+
+// index of the power of two size class that holds bytes, or numSizeClasses if it is too large to pool
+static size_t sizeClass(size_t bytes) {
+    size_t shift = minBlockShift;
+    while ((size_t(1) << shift) < bytes) {
+        shift++;
+    }
+    return shift - minBlockShift;
+}
+
+void *allocateLimbs(size_t bytes) {
+    size_t index = sizeClass(bytes);
+    if (index >= numSizeClasses || LimbPool::destroyed) {
+        return malloc(bytes);
+    }
+
+    FreeBlock *block = limbPool.freeLists[index];
+    if (block != nullptr) {
+        limbPool.freeLists[index] = block->next;
+        return block;
+    }
+    return malloc(size_t(1) << (index + minBlockShift));
+}
+
+void deallocateLimbs(void *block, size_t bytes) {
+    size_t index = sizeClass(bytes);
+    if (index >= numSizeClasses || LimbPool::destroyed) {
+        free(block);
+        return;
+    }
+
+    FreeBlock *freed = static_cast<FreeBlock *>(block);
+    freed->next = limbPool.freeLists[index];
+    limbPool.freeLists[index] = freed;
+}
+
+// magnitude helpers:
+
+using Limbs = BigInteger::Limbs;
+
+static void trim(Limbs &limbs) {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+
+static int compareMagnitude(const Limbs &left, const Limbs &right) {
+    if (left.size() != right.size()) {
+        return (left.size() < right.size()) ? -1 : 1;
+    }
+    for (size_t i = left.size(); i-- > 0;) {
+        if (left[i] != right[i]) {
+            return (left[i] < right[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static Limbs addMagnitude(const Limbs &left, const Limbs &right) {
+    const Limbs &longer = (left.size() >= right.size()) ? left : right;
+    const Limbs &shorter = (left.size() >= right.size()) ? right : left;
+    Limbs result;
+    result.reserve(longer.size() + 1);
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < longer.size(); i++) {
+        uint64_t sum = uint64_t(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+        result.push_back(uint32_t(sum));
+        carry = sum >> 32;
+    }
+    if (carry != 0) {
+        result.push_back(uint32_t(carry));
+    }
+    return result;
+}
+
+// requires |left| >= |right|
+static Limbs subtractMagnitude(const Limbs &left, const Limbs &right) {
+    Limbs result;
+    result.reserve(left.size());
+
+    int64_t borrow = 0;
+    for (size_t i = 0; i < left.size(); i++) {
+        int64_t difference = int64_t(left[i]) - (i < right.size() ? right[i] : 0) - borrow;
+        borrow = (difference < 0) ? 1 : 0;
+        result.push_back(uint32_t(difference + (borrow << 32)));
+    }
+    trim(result);
+    return result;
+}
+
+static Limbs multiplyMagnitude(const Limbs &left, const Limbs &right) {
+    if (left.empty() || right.empty()) {
+        return Limbs();
+    }
+
+    Limbs result(left.size() + right.size(), 0);
+    for (size_t i = 0; i < left.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < right.size(); j++) {
+            uint64_t product = uint64_t(left[i]) * right[j] + result[i + j] + carry;
+            result[i + j] = uint32_t(product);
+            carry = product >> 32;
+        }
+        result[i + right.size()] = uint32_t(carry);
+    }
+    trim(result);
+    return result;
+}
+
+// divides in place by a single limb and returns the remainder
+static uint32_t divideSmall(Limbs &limbs, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+        uint64_t current = (remainder << 32) | limbs[i];
+        limbs[i] = uint32_t(current / divisor);
+        remainder = current % divisor;
+    }
+    trim(limbs);
+    return uint32_t(remainder);
+}
+
+// schoolbook long division (Knuth algorithm D), divisor must be non-zero
+static void divideMagnitude(const Limbs &dividend, const Limbs &divisor, Limbs &quotient, Limbs &remainder) {
+    if (compareMagnitude(dividend, divisor) < 0) {
+        quotient.clear();
+        remainder = dividend;
+        return;
+    }
+
+    if (divisor.size() == 1) {
+        quotient = dividend;
+        uint32_t rest = divideSmall(quotient, divisor[0]);
+        remainder.clear();
+        if (rest != 0) {
+            remainder.push_back(rest);
+        }
+        return;
+    }
+
+    size_t n = divisor.size();
+    size_t m = dividend.size();
+    int shift = __builtin_clz(divisor.back());
+
+    // normalize so the top limb of the divisor has its high bit set
+    Limbs v(n), u(m + 1);
+    for (size_t i = n - 1; i > 0; i--) {
+        v[i] = (divisor[i] << shift) | (shift ? uint32_t(uint64_t(divisor[i - 1]) >> (32 - shift)) : 0);
+    }
+    v[0] = divisor[0] << shift;
+    u[m] = shift ? uint32_t(uint64_t(dividend[m - 1]) >> (32 - shift)) : 0;
+    for (size_t i = m - 1; i > 0; i--) {
+        u[i] = (dividend[i] << shift) | (shift ? uint32_t(uint64_t(dividend[i - 1]) >> (32 - shift)) : 0);
+    }
+    u[0] = dividend[0] << shift;
+
+    quotient.assign(m - n + 1, 0);
+    const uint64_t base = uint64_t(1) << 32;
+    for (size_t j = m - n + 1; j-- > 0;) {
+        uint64_t top = (uint64_t(u[j + n]) << 32) | u[j + n - 1];
+        uint64_t qhat = top / v[n - 1];
+        uint64_t rhat = top % v[n - 1];
+        while (qhat >= base || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+            qhat--;
+            rhat += v[n - 1];
+            if (rhat >= base) {
+                break;
+            }
+        }
+
+        // multiply and subtract
+        int64_t borrow = 0;
+        int64_t t;
+        for (size_t i = 0; i < n; i++) {
+            uint64_t product = qhat * v[i];
+            t = int64_t(u[i + j]) - borrow - int64_t(product & 0xFFFFFFFF);
+            u[i + j] = uint32_t(t);
+            borrow = int64_t(product >> 32) - (t >> 32);
+        }
+        t = int64_t(u[j + n]) - borrow;
+        u[j + n] = uint32_t(t);
+
+        quotient[j] = uint32_t(qhat);
+        if (t < 0) {
+            // qhat was one too large, add the divisor back
+            quotient[j]--;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t sum = uint64_t(u[i + j]) + v[i] + carry;
+                u[i + j] = uint32_t(sum);
+                carry = sum >> 32;
+            }
+            u[j + n] += uint32_t(carry);
+        }
+    }
+    trim(quotient);
+
+    // unnormalize the remainder
+    remainder.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        remainder[i] = (u[i] >> shift) | (shift ? uint32_t(uint64_t(u[i + 1]) << (32 - shift)) : 0);
+    }
+    trim(remainder);
+}
+
+// BigInteger:
+
+BigInteger::BigInteger() : negative(false) {}
+
+BigInteger::BigInteger(__int128 value) : negative(value < 0) {
+    unsigned __int128 digits = magnitude(value);
+    while (digits != 0) {
+        limbs.push_back(uint32_t(digits));
+        digits >>= 32;
+    }
+}
+
+BigInteger BigInteger::fromDigits(const string &digits) {
+    BigInteger result;
+    for (size_t i = 0; i < digits.length(); i += 9) {
+        size_t length = min(size_t(9), digits.length() - i);
+        uint32_t scale = 1;
+        uint32_t chunk = 0;
+        for (size_t j = i; j < i + length; j++) {
+            scale *= 10;
+            chunk = chunk * 10 + uint32_t(digits[j] - '0');
+        }
+
+        // result = result * scale + chunk
+        uint64_t carry = chunk;
+        for (size_t j = 0; j < result.limbs.size(); j++) {
+            uint64_t current = uint64_t(result.limbs[j]) * scale + carry;
+            result.limbs[j] = uint32_t(current);
+            carry = current >> 32;
+        }
+        if (carry != 0) {
+            result.limbs.push_back(uint32_t(carry));
+        }
+    }
+    trim(result.limbs);
+    return result;
+}
+
+bool BigInteger::isZero() const {
+    return limbs.empty();
+}
+
+bool BigInteger::isNegative() const {
+    return negative;
+}
+
+bool BigInteger::fitsInt64() const {
+    if (limbs.size() <= 1) {
+        return true;
+    }
+    if (limbs.size() > 2) {
+        return false;
+    }
+    uint64_t digits = (uint64_t(limbs[1]) << 32) | limbs[0];
+    return digits <= (negative ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX));
+}
+
+int64_t BigInteger::toInt64() const {
+    uint64_t digits = 0;
+    for (size_t i = limbs.size(); i-- > 0;) {
+        digits = (digits << 32) | limbs[i];
+    }
+    return negative ? int64_t(uint64_t(0) - digits) : int64_t(digits);
+}
+
+string BigInteger::toString() const {
+    if (limbs.empty()) {
+        return "0";
+    }
+
+    // peel off base 10^9 chunks from the least significant end
+    Limbs digits = limbs;
+    vector<uint32_t> chunks;
+    while (!digits.empty()) {
+        chunks.push_back(divideSmall(digits, 1000000000));
+    }
+
+    string result = negative ? "-" : "";
+    result += to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        string chunk = to_string(chunks[i]);
+        result.append(9 - chunk.length(), '0');
+        result += chunk;
+    }
+    return result;
+}
+
+BigInteger operator+(const BigInteger &left, const BigInteger &right) {
+    BigInteger result;
+    if (left.negative == right.negative) {
+        result.limbs = addMagnitude(left.limbs, right.limbs);
+        result.negative = left.negative;
+    } else if (compareMagnitude(left.limbs, right.limbs) >= 0) {
+        result.limbs = subtractMagnitude(left.limbs, right.limbs);
+        result.negative = left.negative;
+    } else {
+        result.limbs = subtractMagnitude(right.limbs, left.limbs);
+        result.negative = right.negative;
+    }
+    result.negative = result.negative && !result.limbs.empty();
+    return result;
+}
+
+BigInteger operator-(const BigInteger &left, const BigInteger &right) {
+    return left + (-right);
+}
+
+BigInteger operator*(const BigInteger &left, const BigInteger &right) {
+    BigInteger result;
+    result.limbs = multiplyMagnitude(left.limbs, right.limbs);
+    result.negative = (left.negative != right.negative) && !result.limbs.empty();
+    return result;
+}
+
+BigInteger operator/(const BigInteger &left, const BigInteger &right) {
+    if (right.limbs.empty()) {
+        throw FractionException("Undefined!");
+    }
+
+    BigInteger result;
+    Limbs remainder;
+    divideMagnitude(left.limbs, right.limbs, result.limbs, remainder);
+    result.negative = (left.negative != right.negative) && !result.limbs.empty();
+    return result;
+}
+
+BigInteger operator-(const BigInteger &value) {
+    BigInteger result = value;
+    result.negative = !value.negative && !value.limbs.empty();
+    return result;
+}
+
+int compare(const BigInteger &left, const BigInteger &right) {
+    if (left.negative != right.negative) {
+        return left.negative ? -1 : 1;
+    }
+    int magnitudeOrder = compareMagnitude(left.limbs, right.limbs);
+    return left.negative ? -magnitudeOrder : magnitudeOrder;
+}
+
+BigInteger gcd(const BigInteger &left, const BigInteger &right) {
+    Limbs x = left.limbs;
+    Limbs y = right.limbs;
+    Limbs quotient, remainder;
+
+    // Euclid on limbs until both values fit in a machine word
+    while (!y.empty() && (x.size() > 2 || y.size() > 2)) {
+        divideMagnitude(x, y, quotient, remainder);
+        x.swap(y);
+        y.swap(remainder);
+    }
+
+    BigInteger result;
+    if (y.empty()) {
+        result.limbs = x;
+        return result;
+    }
+
+    uint64_t a = (x.size() > 1) ? ((uint64_t(x[1]) << 32) | x[0]) : (x.empty() ? 0 : x[0]);
+    uint64_t b = (y.size() > 1) ? ((uint64_t(y[1]) << 32) | y[0]) : y[0];
+    a = binaryGcd(a, b);
+    return BigInteger(__int128(a));
+}
+
+ostream &operator<<(ostream &out, const BigInteger &value) {
+    out << value.toString();
+    return out;
+}
+
+// BigFraction:
+
+BigFraction::BigFraction() : small(true), smallNum(0), smallDenom(1) {}
+
+BigFraction::BigFraction(int64_t num) : small(true), smallNum(num), smallDenom(1) {}
+
+BigFraction::BigFraction(int64_t num, int64_t denom) : BigFraction() {
+    // throw exception if fraction is undefined
+    if (denom == 0) {
+        throw FractionException("Undefined!");
+    }
+    *this = fromWide(num, denom);
+}
+
+BigFraction::BigFraction(const BigInteger &num, const BigInteger &denom) : BigFraction() {
+    // throw exception if fraction is undefined
+    if (denom.isZero()) {
+        throw FractionException("Undefined!");
+    }
+    *this = fromBig(num, denom);
+}
+
+bool BigFraction::isSmall() const {
+    return small;
+}
+
+BigInteger BigFraction::numerator() const {
+    return small ? BigInteger(smallNum) : bigNum;
+}
+
+BigInteger BigFraction::denominator() const {
+    return small ? BigInteger(smallDenom) : bigDenom;
+}
+
+BigFraction BigFraction::fromWide(__int128 num, __int128 denom) {
+    if (num == 0) {
+        return BigFraction();
+    }
+
+    bool isNegative = (num < 0) != (denom < 0);
+    unsigned __int128 x = magnitude(num);
+    unsigned __int128 y = magnitude(denom);
+
+    unsigned __int128 factor = binaryGcd(x, y);
+    x /= factor;
+    y /= factor;
+
+    if (y <= uint64_t(INT64_MAX) && x <= (isNegative ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX))) {
+        BigFraction result;
+        result.smallNum = isNegative ? int64_t(uint64_t(0) - uint64_t(x)) : int64_t(x);
+        result.smallDenom = int64_t(y);
+        return result;
+    }
+
+    BigFraction result;
+    result.small = false;
+    result.bigNum = BigInteger(isNegative ? -__int128(x) : __int128(x));
+    result.bigDenom = BigInteger(__int128(y));
+    return result;
+}
+
+BigFraction BigFraction::fromBig(BigInteger num, BigInteger denom) {
+    if (num.isZero()) {
+        return BigFraction();
+    }
+    if (denom.isNegative()) {
+        num = -num;
+        denom = -denom;
+    }
+
+    BigInteger factor = gcd(num, denom);
+    if (compare(factor, BigInteger(1)) != 0) {
+        num = num / factor;
+        denom = denom / factor;
+    }
+
+    // move back to inline storage whenever the reduced value fits
+    BigFraction result;
+    if (num.fitsInt64() && denom.fitsInt64()) {
+        result.smallNum = num.toInt64();
+        result.smallDenom = denom.toInt64();
+    } else {
+        result.small = false;
+        result.bigNum = num;
+        result.bigDenom = denom;
+    }
+    return result;
+}
+
+int BigFraction::compareFractions(const BigFraction &left, const BigFraction &right) {
+    if (left.small && right.small) {
+        __int128 leftCross = __int128(left.smallNum) * right.smallDenom;
+        __int128 rightCross = __int128(right.smallNum) * left.smallDenom;
+        return (leftCross < rightCross) ? -1 : (leftCross > rightCross);
+    }
+    return compare(left.numerator() * right.denominator(), right.numerator() * left.denominator());
+}
+
+BigFraction &BigFraction::operator+=(const BigFraction &right) {
+    *this = *this + right;
+    return *this;
+}
+
+BigFraction operator+(const BigFraction &left, const BigFraction &right) {
+    // 64-bit operands cannot overflow a 128-bit cross-multiplication
+    if (left.small && right.small) {
+        return BigFraction::fromWide(__int128(left.smallNum) * right.smallDenom + __int128(right.smallNum) * left.smallDenom,
+                                     __int128(left.smallDenom) * right.smallDenom);
+    }
+    return BigFraction::fromBig(left.numerator() * right.denominator() + right.numerator() * left.denominator(),
+                                left.denominator() * right.denominator());
+}
+
+BigFraction operator-(const BigFraction &left, const BigFraction &right) {
+    return left + (-right);
+}
+
+BigFraction operator*(const BigFraction &left, const BigFraction &right) {
+    if (left.small && right.small) {
+        return BigFraction::fromWide(__int128(left.smallNum) * right.smallNum, __int128(left.smallDenom) * right.smallDenom);
+    }
+    return BigFraction::fromBig(left.numerator() * right.numerator(), left.denominator() * right.denominator());
+}
+
+BigFraction operator/(const BigFraction &left, const BigFraction &right) {
+    if (right.small && right.smallNum == 0) {
+        throw FractionException("Undefined!");
+    }
+    if (left.small && right.small) {
+        return BigFraction::fromWide(__int128(left.smallNum) * right.smallDenom, __int128(left.smallDenom) * right.smallNum);
+    }
+    return BigFraction::fromBig(left.numerator() * right.denominator(), left.denominator() * right.numerator());
+}
+
+BigFraction operator-(const BigFraction &fraction) {
+    if (fraction.small) {
+        return BigFraction::fromWide(-__int128(fraction.smallNum), fraction.smallDenom);
+    }
+    BigFraction result = fraction;
+    result.bigNum = -fraction.bigNum;
+    return result;
+}
+
+bool operator==(const BigFraction &left, const BigFraction &right) {
+    return BigFraction::compareFractions(left, right) == 0;
+}
+
+bool operator!=(const BigFraction &left, const BigFraction &right) {
+    return BigFraction::compareFractions(left, right) != 0;
+}
+
+bool operator<(const BigFraction &left, const BigFraction &right) {
+    return BigFraction::compareFractions(left, right) < 0;
+}
+
+bool operator<=(const BigFraction &left, const BigFraction &right) {
+    return BigFraction::compareFractions(left, right) <= 0;
+}
+
+bool operator>(const BigFraction &left, const BigFraction &right) {
+    return BigFraction::compareFractions(left, right) > 0;
+}
+
+bool operator>=(const BigFraction &left, const BigFraction &right) {
+    return BigFraction::compareFractions(left, right) >= 0;
+}
+
+ostream &operator<<(ostream &out, const BigFraction &fraction) {
+    out << fraction.numerator() << "/" << fraction.denominator();
+    return out;
+}
+
+istream &operator>>(istream &in, BigFraction &fraction) {
+    string input;
+    in.clear();
+    in >> input;
+    size_t found = input.find('/');
+
+    // handle '/' input case
+    if (found != string::npos) {
+        string numString = input.substr(0, (found));
+        string denomString = input.substr((found + 1), input.length());
+
+        // check if input contains only digits zero to nine inclusive
+        if (digitCheck(numString) && digitCheck(denomString)) {
+            fraction = BigFraction(BigInteger::fromDigits(numString), BigInteger::fromDigits(denomString));
+        } else {
+            throw FractionException("Invalid input!");
+        }
+    // handle integer input case
+    } else {
+        // check if input contains only digits zero to nine inclusive
+        if (digitCheck(input)) {
+            fraction = BigFraction(BigInteger::fromDigits(input), BigInteger(1));
+        } else {
+            throw FractionException("Invalid input!");
+        }
+    }
+
+    return in;
+}
@@ -0,0 +1,123 @@
+/*
+File: bigFraction.h
+Author: Logan Copeland
+Description: Arbitrary precision fraction class header file
+*/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "fractionCalculator.h"
+
+using namespace std;
+
+// pooled storage for bignum limbs, freed blocks are recycled per thread so hot loops avoid malloc
+void *allocateLimbs(size_t bytes);
+void deallocateLimbs(void *block, size_t bytes);
+
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    T *allocate(size_t count) {
+        return static_cast<T *>(allocateLimbs(count * sizeof(T)));
+    }
+
+    void deallocate(T *block, size_t count) {
+        deallocateLimbs(block, count * sizeof(T));
+    }
+
+    friend bool operator==(const PoolAllocator &, const PoolAllocator &) {
+        return true;
+    }
+};
+
+// sign-magnitude integer stored as little-endian 32-bit limbs
+class BigInteger {
+public:
+    using Limbs = vector<uint32_t, PoolAllocator<uint32_t>>;
+
+    BigInteger(); // default constructor
+    BigInteger(__int128 value); // constructor
+    static BigInteger fromDigits(const string &digits); // parses a string of decimal digits
+
+    bool isZero() const;
+    bool isNegative() const;
+    bool fitsInt64() const; // true if the value can be returned by toInt64()
+    int64_t toInt64() const;
+    string toString() const;
+
+    friend BigInteger operator+(const BigInteger &left, const BigInteger &right);
+    friend BigInteger operator-(const BigInteger &left, const BigInteger &right);
+    friend BigInteger operator*(const BigInteger &left, const BigInteger &right);
+    friend BigInteger operator/(const BigInteger &left, const BigInteger &right); // truncating division
+    friend BigInteger operator-(const BigInteger &value);
+    friend int compare(const BigInteger &left, const BigInteger &right); // -1, 0 or 1
+    friend BigInteger gcd(const BigInteger &left, const BigInteger &right); // non-negative greatest common divisor
+
+private:
+    Limbs limbs; // magnitude, no trailing zero limbs (zero is empty)
+    bool negative; // sign, always false for zero
+};
+
+int compare(const BigInteger &left, const BigInteger &right);
+BigInteger gcd(const BigInteger &left, const BigInteger &right);
+
+// fraction that keeps small values in two inline 64-bit integers and only moves to
+// heap-backed BigIntegers once a result no longer fits
+class BigFraction {
+public:
+    BigFraction(); // default constructor
+    BigFraction(int64_t num); // constructor
+    BigFraction(int64_t num, int64_t denom); // constructor
+    BigFraction(const BigInteger &num, const BigInteger &denom); // constructor
+
+    template <typename T>
+    BigFraction(const Fraction<T> &fraction); // conversion from Fraction
+
+    bool isSmall() const; // true while the value is stored inline
+    BigInteger numerator() const; // num getter
+    BigInteger denominator() const; // denom getter
+
+    BigFraction &operator+=(const BigFraction &right); // += operator overloading
+
+    friend BigFraction operator+(const BigFraction &left, const BigFraction &right); // + operator overloading
+    friend BigFraction operator-(const BigFraction &left, const BigFraction &right); // - (subtraction) operator overloading
+    friend BigFraction operator*(const BigFraction &left, const BigFraction &right); // * operator overloading
+    friend BigFraction operator/(const BigFraction &left, const BigFraction &right); // / operator overloading
+    friend BigFraction operator-(const BigFraction &fraction); // - (negation) operator overloading
+
+    friend bool operator==(const BigFraction &left, const BigFraction &right); // == operator overloading
+    friend bool operator!=(const BigFraction &left, const BigFraction &right); // != operator overloading
+    friend bool operator<(const BigFraction &left, const BigFraction &right); // < operator overloading
+    friend bool operator<=(const BigFraction &left, const BigFraction &right); // <= operator overloading
+    friend bool operator>(const BigFraction &left, const BigFraction &right); // > operator overloading
+    friend bool operator>=(const BigFraction &left, const BigFraction &right); // >= operator overloading
+
+private:
+    bool small; // selects between the inline and heap representations
+    int64_t smallNum; // numerator while small
+    int64_t smallDenom; // denominator while small
+    BigInteger bigNum; // numerator once large
+    BigInteger bigDenom; // denominator once large
+
+    static BigFraction fromWide(__int128 num, __int128 denom); // normalizes a 128-bit intermediate result
+    static BigFraction fromBig(BigInteger num, BigInteger denom); // normalizes a BigInteger result
+    static int compareFractions(const BigFraction &left, const BigFraction &right); // -1, 0 or 1
+};
+
+template <typename T>
+BigFraction::BigFraction(const Fraction<T> &fraction) : BigFraction(BigInteger(fraction.numerator()), BigInteger(fraction.denominator())) {}
+
+ostream &operator<<(ostream &out, const BigInteger &value); // << operator overloading
+ostream &operator<<(ostream &out, const BigFraction &fraction); // << operator overloading
+istream &operator>>(istream &in, BigFraction &fraction); // >> operator overloading
@@ -0,0 +1,182 @@
+/*
+File: fractionAccumulator.h
+Author: Logan Copeland
+Description: Running fraction sum or product that defers normalization until it is needed
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "fractionCalculator.h"
+
+using namespace std;
+
+// Sums (or multiplies) Fraction<T> terms in a wider integer type without reducing after every
+// term. The common factor is only divided out when the next term would overflow the wide
+// numerator or denominator, or when the result is read.
+template <typename T = int>
+class FractionAccumulator {
+public:
+    using Wide = conditional_t<(sizeof(T) < sizeof(int64_t)), int64_t, __int128>;
+
+    constexpr FractionAccumulator(); // default constructor, starts at zero
+    constexpr FractionAccumulator(const Fraction<T> &initial); // constructor
+
+    constexpr FractionAccumulator &operator+=(const Fraction<T> &term); // += operator overloading
+    constexpr FractionAccumulator &operator+=(const FractionAccumulator &other); // adds another partial sum
+    constexpr FractionAccumulator &operator*=(const Fraction<T> &term); // *= operator overloading
+    constexpr FractionAccumulator &operator*=(const FractionAccumulator &other); // multiplies by another partial product
+    constexpr Fraction<T> result(); // normalized value, throws FractionException if it does not fit in T
+
+private:
+    using W = make_unsigned_t<Wide>;
+
+    Wide num; // unreduced numerator
+    Wide denom; // unreduced denominator, always positive
+
+    constexpr bool tryAdd(Wide termNum, Wide termDenom); // unreduced add, false if it would overflow
+    constexpr bool tryMultiply(Wide termNum, Wide termDenom); // unreduced multiply, false if it would overflow
+    constexpr void add(Wide termNum, Wide termDenom);
+    constexpr void multiply(Wide termNum, Wide termDenom);
+    constexpr void reduce(); // divides out the common factor
+    static constexpr void reduce(Wide &termNum, Wide &termDenom); // divides out the common factor of a term
+};
+
+template <typename T>
+constexpr FractionAccumulator<T>::FractionAccumulator() : num(0), denom(1) {}
+
+template <typename T>
+constexpr FractionAccumulator<T>::FractionAccumulator(const Fraction<T> &initial) : num(initial.numerator()), denom(initial.denominator()) {}
+
+template <typename T>
+constexpr bool FractionAccumulator<T>::tryAdd(Wide termNum, Wide termDenom) {
+    Wide sum;
+    if (termDenom == denom) {
+        if (__builtin_add_overflow(num, termNum, &sum)) {
+            return false;
+        }
+        num = sum;
+        return true;
+    }
+
+    Wide leftCross, rightCross, product;
+    if (__builtin_mul_overflow(num, termDenom, &leftCross) || __builtin_mul_overflow(termNum, denom, &rightCross) ||
+        __builtin_add_overflow(leftCross, rightCross, &sum) || __builtin_mul_overflow(denom, termDenom, &product)) {
+        return false;
+    }
+    num = sum;
+    denom = product;
+    return true;
+}
+
+template <typename T>
+constexpr bool FractionAccumulator<T>::tryMultiply(Wide termNum, Wide termDenom) {
+    Wide productNum, productDenom;
+    if (__builtin_mul_overflow(num, termNum, &productNum) || __builtin_mul_overflow(denom, termDenom, &productDenom)) {
+        return false;
+    }
+    num = productNum;
+    denom = productDenom;
+    return true;
+}
+
+template <typename T>
+constexpr void FractionAccumulator<T>::reduce() {
+    reduce(num, denom);
+}
+
+template <typename T>
+constexpr void FractionAccumulator<T>::reduce(Wide &termNum, Wide &termDenom) {
+    if (termNum == 0) {
+        termDenom = 1;
+        return;
+    }
+
+    Wide factor = Wide(binaryGcd(magnitude(termNum), W(termDenom)));
+    termNum /= factor;
+    termDenom /= factor;
+}
+
+template <typename T>
+constexpr void FractionAccumulator<T>::add(Wide termNum, Wide termDenom) {
+    if (tryAdd(termNum, termDenom)) {
+        return;
+    }
+
+    // close to overflow, normalize both sides and retry, the term may be another unreduced partial sum
+    reduce();
+    reduce(termNum, termDenom);
+    if (tryAdd(termNum, termDenom)) {
+        return;
+    }
+
+    // still too large when unreduced, add exactly by dividing out the common
+    // factor of the denominators first
+    Wide factor = Wide(binaryGcd(W(denom), W(termDenom)));
+    Wide leftScale = termDenom / factor;
+    Wide rightScale = denom / factor;
+    num = checkedAdd(checkedMul(num, leftScale), checkedMul(termNum, rightScale));
+    denom = checkedMul(rightScale, termDenom);
+    reduce();
+}
+
+template <typename T>
+constexpr void FractionAccumulator<T>::multiply(Wide termNum, Wide termDenom) {
+    if ((num == 0) || (termNum == 0)) {
+        num = 0;
+        denom = 1;
+        return;
+    }
+    if (tryMultiply(termNum, termDenom)) {
+        return;
+    }
+
+    // close to overflow, normalize both sides and retry, the term may be another unreduced partial product
+    reduce();
+    reduce(termNum, termDenom);
+    if (tryMultiply(termNum, termDenom)) {
+        return;
+    }
+
+    // still too large, cross-cancel before multiplying
+    Wide leftFactor = Wide(binaryGcd(magnitude(num), W(termDenom)));
+    Wide rightFactor = Wide(binaryGcd(magnitude(termNum), W(denom)));
+    num = checkedMul(num / leftFactor, termNum / rightFactor);
+    denom = checkedMul(denom / rightFactor, termDenom / leftFactor);
+}
+
+template <typename T>
+constexpr FractionAccumulator<T> &FractionAccumulator<T>::operator+=(const Fraction<T> &term) {
+    add(term.numerator(), term.denominator());
+    return *this;
+}
+
+template <typename T>
+constexpr FractionAccumulator<T> &FractionAccumulator<T>::operator+=(const FractionAccumulator &other) {
+    add(other.num, other.denom);
+    return *this;
+}
+
+template <typename T>
+constexpr FractionAccumulator<T> &FractionAccumulator<T>::operator*=(const Fraction<T> &term) {
+    multiply(term.numerator(), term.denominator());
+    return *this;
+}
+
+template <typename T>
+constexpr FractionAccumulator<T> &FractionAccumulator<T>::operator*=(const FractionAccumulator &other) {
+    multiply(other.num, other.denom);
+    return *this;
+}
+
+template <typename T>
+constexpr Fraction<T> FractionAccumulator<T>::result() {
+    reduce();
+
+    if ((num < Wide(numeric_limits<T>::min())) || (num > Wide(numeric_limits<T>::max())) || (denom > Wide(numeric_limits<T>::max()))) {
+        throw FractionException("Overflow!");
+    }
+    return Fraction<T>(T(num), T(denom), typename Fraction<T>::Reduced());
+}
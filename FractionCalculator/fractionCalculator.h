@@ -8,55 +8,520 @@ Description: Fraction class header file
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <compare>
+#include <expected>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <functional>
 
 using namespace std;
 
+class FractionException {
+public:
+    FractionException(const string &message); // constructor
+    string what() const; // error message return method
+
+private:
+    string errorMessage; // error message
+};
+
+// errors reported by the non-throwing API
+enum class FractionError {
+    Undefined, // zero denominator or division by zero
+    Overflow, // the result does not fit in the integer type
+    InvalidInput // text that is not an integer or x/y fraction of digits
+};
+
+// message the throwing API reports for an error, e.g. "Undefined!"
+const char *errorMessage(FractionError error);
+
+// value of a non-throwing result, throws the matching FractionException if it holds an error
+template <typename V>
+constexpr V valueOrThrow(const expected<V, FractionError> &result) {
+    if (!result) {
+        throw FractionException(errorMessage(result.error()));
+    }
+    return *result;
+}
+
+// checked integer arithmetic, throws FractionException on overflow
+template <typename T>
+constexpr T checkedAdd(T x, T y) {
+    T result;
+    if (__builtin_add_overflow(x, y, &result)) {
+        throw FractionException("Overflow!");
+    }
+    return result;
+}
+
+template <typename T>
+constexpr T checkedSub(T x, T y) {
+    T result;
+    if (__builtin_sub_overflow(x, y, &result)) {
+        throw FractionException("Overflow!");
+    }
+    return result;
+}
+
+template <typename T>
+constexpr T checkedMul(T x, T y) {
+    T result;
+    if (__builtin_mul_overflow(x, y, &result)) {
+        throw FractionException("Overflow!");
+    }
+    return result;
+}
+
+template <typename T>
+constexpr T checkedNeg(T x) {
+    return checkedSub(T(0), x);
+}
+
+// magnitude of a signed integer as its unsigned counterpart (well defined for the minimum value)
+template <typename T>
+constexpr make_unsigned_t<T> magnitude(T x) {
+    using U = make_unsigned_t<T>;
+    return (x < 0) ? (U(0) - U(x)) : U(x);
+}
+
+// number of trailing zero bits of a non-zero unsigned integer
+template <typename U>
+constexpr int trailingZeros(U x) {
+    if constexpr (sizeof(U) <= sizeof(unsigned int)) {
+        return __builtin_ctz(x);
+    } else if constexpr (sizeof(U) <= sizeof(unsigned long long)) {
+        return __builtin_ctzll(x);
+    } else {
+        uint64_t low = uint64_t(x);
+        return (low != 0) ? __builtin_ctzll(low) : 64 + __builtin_ctzll(uint64_t(x >> 64));
+    }
+}
+
+// greatest common divisor of two unsigned integers using Stein's binary algorithm,
+// gcd(0, y) is y and gcd(0, 0) is 0
+template <typename U>
+constexpr U binaryGcd(U x, U y) {
+    if (x == 0) {
+        return y;
+    }
+    if (y == 0) {
+        return x;
+    }
+
+    // common powers of two are restored at the end, the loop only sees odd values
+    int shift = trailingZeros(U(x | y));
+    x >>= trailingZeros(x);
+    do {
+        y >>= trailingZeros(y);
+        // min/max instead of a swap branch so the compiler can use conditional moves
+        U smaller = (x < y) ? x : y;
+        y = (x < y) ? (y - x) : (x - y);
+        x = smaller;
+    } while (y != 0);
+
+    return x << shift;
+}
+
+// full product of two unsigned integers as a high and a low half
+template <typename U>
+constexpr void multiplyWide(U x, U y, U &high, U &low) {
+    constexpr int halfBits = numeric_limits<U>::digits / 2;
+    constexpr U halfMask = (U(1) << halfBits) - 1;
+
+    U x0 = x & halfMask, x1 = x >> halfBits;
+    U y0 = y & halfMask, y1 = y >> halfBits;
+    U p00 = x0 * y0, p01 = x0 * y1, p10 = x1 * y0, p11 = x1 * y1;
+
+    U middle = (p00 >> halfBits) + (p01 & halfMask) + (p10 & halfMask);
+    low = (middle << halfBits) | (p00 & halfMask);
+    high = p11 + (p01 >> halfBits) + (p10 >> halfBits) + (middle >> halfBits);
+}
+
+template <typename T = int>
 class Fraction {
+    static_assert(is_integral_v<T> && is_signed_v<T>, "Fraction requires a signed integer type");
+
 public:
-    Fraction(); // default constructor
-    Fraction(int num); // constructor
-    Fraction(int num, int denom); // constructor
-    int numerator() const; // num getter
-    int denominator() const; // denom getter
+    using value_type = T;
+    using Result = expected<Fraction, FractionError>; // fraction or the error the throwing API would report
+
+    constexpr Fraction(); // default constructor
+    constexpr Fraction(T num); // constructor
+    constexpr Fraction(T num, T denom); // constructor, throws FractionException("Undefined!") if denom is zero
+    static constexpr Result create(T num, T denom) noexcept; // non-throwing constructor
+    constexpr T numerator() const; // num getter
+    constexpr T denominator() const; // denom getter
+
+    // non-throwing arithmetic, the operators below are wrappers around these:
+
+    friend constexpr Result tryAdd(const Fraction &left, const Fraction &right) noexcept {
+        return add(left.num, left.denom, right.num, right.denom);
+    }
+
+    friend constexpr Result trySubtract(const Fraction &left, const Fraction &right) noexcept {
+        T negated;
+        if (__builtin_sub_overflow(T(0), right.num, &negated)) {
+            return unexpected(FractionError::Overflow);
+        }
+        return add(left.num, left.denom, negated, right.denom);
+    }
+
+    friend constexpr Result tryMultiply(const Fraction &left, const Fraction &right) noexcept {
+        return multiply(left.num, left.denom, right.num, right.denom);
+    }
+
+    friend constexpr Result tryDivide(const Fraction &left, const Fraction &right) noexcept {
+        if (right.num == 0) {
+            return unexpected(FractionError::Undefined);
+        }
+
+        // multiply by the inverse, multiply() takes care of the sign of its denominator
+        return multiply(left.num, left.denom, right.denom, right.num);
+    }
 
     // unary operators:
 
-    Fraction &operator+=(const Fraction &right); // += operator overloading
-    Fraction &operator++(); // ++ (pre-increment) operator overloading
-    Fraction operator++(int unused); // ++ (post-increment) operator overloading
+    constexpr Fraction &operator+=(const Fraction &right); // += operator overloading
+    constexpr Fraction &operator++(); // ++ (pre-increment) operator overloading
+    constexpr Fraction operator++(int unused); // ++ (post-increment) operator overloading
+
+    // binary operators (hidden friends so that integers convert implicitly on either side):
+
+    friend constexpr Fraction operator+(const Fraction &left, const Fraction &right) { // + operator overloading
+        return valueOrThrow(tryAdd(left, right));
+    }
+
+    friend constexpr Fraction operator-(const Fraction &left, const Fraction &right) { // - (subtraction) operator overloading
+        return valueOrThrow(trySubtract(left, right));
+    }
+
+    friend constexpr Fraction operator*(const Fraction &left, const Fraction &right) { // * operator overloading
+        return valueOrThrow(tryMultiply(left, right));
+    }
+
+    friend constexpr Fraction operator/(const Fraction &left, const Fraction &right) { // / operator overloading
+        return valueOrThrow(tryDivide(left, right));
+    }
+
+    friend constexpr Fraction operator-(const Fraction &fraction) { // - (negation) operator overloading
+        return Fraction(checkedNeg(fraction.num), fraction.denom, Reduced());
+    }
+
+    friend constexpr bool operator==(const Fraction &left, const Fraction &right) { // == operator overloading
+        return (left.num == right.num) && (left.denom == right.denom);
+    }
+
+    friend constexpr bool operator!=(const Fraction &left, const Fraction &right) { // != operator overloading
+        return (left.num != right.num) || (left.denom != right.denom);
+    }
+
+    friend constexpr strong_ordering operator<=>(const Fraction &left, const Fraction &right) { // exact three-way comparison, also provides < <= > >=
+        return compare(left, right);
+    }
 
 private:
-    int num; // numerator
-    int denom; // denominator
-    int gcd(int num, int denom); // greatest common divisor method
+    using U = make_unsigned_t<T>;
+    using Wide = conditional_t<(sizeof(T) <= sizeof(int32_t)), int64_t, __int128>; // holds any product of two T values except for T = __int128
+    using UW = make_unsigned_t<Wide>;
+
+    template <typename> friend class FractionAccumulator;
+
+    struct Reduced {}; // tag for values that are already in lowest terms with a positive denominator
+
+    T num; // numerator
+    T denom; // denominator
+
+    constexpr Fraction(T num, T denom, Reduced); // constructor for normalized values
+    static constexpr U gcd(U x, U y); // greatest common divisor method
+    template <typename W>
+    static constexpr Result normalize(W num, W denom, bool negative) noexcept; // builds a normalized fraction from magnitudes
+    template <typename W>
+    static constexpr Result fromMagnitudes(W num, W denom, bool negative) noexcept; // range checks magnitudes already in lowest terms
+    static constexpr Result add(T leftNum, T leftDenom, T rightNum, T rightDenom) noexcept; // normalized sum
+    static constexpr Result multiply(T leftNum, T leftDenom, T rightNum, T rightDenom) noexcept; // normalized product
+    static constexpr strong_ordering compare(const Fraction &left, const Fraction &right); // cross-multiplies in a wider type
+};
+
+template <typename T>
+constexpr Fraction<T>::Fraction() : num(0), denom(1) {}
+
+template <typename T>
+constexpr Fraction<T>::Fraction(T num) : num(num), denom(1) {}
+
+template <typename T>
+constexpr Fraction<T>::Fraction(T num, T denom) : Fraction(valueOrThrow(create(num, denom))) {}
+
+template <typename T>
+constexpr typename Fraction<T>::Result Fraction<T>::create(T num, T denom) noexcept {
+    // fraction is undefined
+    if (denom == 0) {
+        return unexpected(FractionError::Undefined);
+    }
+
+    // simplify fraction, zero is always stored as 0/1
+    if (num == 0) {
+        return Fraction();
+    }
+    return normalize(magnitude(num), magnitude(denom), (num < 0) != (denom < 0));
+}
+
+template <typename T>
+constexpr Fraction<T>::Fraction(T num, T denom, Reduced) : num(num), denom(denom) {}
+
+template <typename T>
+constexpr T Fraction<T>::numerator() const {
+    return num;
+}
+
+template <typename T>
+constexpr T Fraction<T>::denominator() const {
+    return denom;
+}
+
+template <typename T>
+constexpr typename Fraction<T>::U Fraction<T>::gcd(U x, U y) {
+    // zero has no common factor to divide out, so gcd(0, 0) reports 1
+    U factor = binaryGcd(x, y);
+    return (factor == 0) ? 1 : factor;
+}
+
+template <typename T>
+template <typename W>
+constexpr typename Fraction<T>::Result Fraction<T>::normalize(W num, W denom, bool negative) noexcept {
+    W factor = binaryGcd(num, denom);
+    return fromMagnitudes(num / factor, denom / factor, negative);
+}
+
+template <typename T>
+template <typename W>
+constexpr typename Fraction<T>::Result Fraction<T>::fromMagnitudes(W num, W denom, bool negative) noexcept {
+    if (num == 0) {
+        return Fraction();
+    }
+
+    // the magnitudes must fit back into T (the numerator may be the minimum value)
+    constexpr W maxValue = W(numeric_limits<T>::max());
+    if ((denom > maxValue) || (num > (negative ? maxValue + 1 : maxValue))) {
+        return unexpected(FractionError::Overflow);
+    }
+
+    T signedNum = negative ? T(U(0) - U(num)) : T(num);
+    return Fraction(signedNum, T(denom), Reduced());
+}
+
+template <typename T>
+constexpr typename Fraction<T>::Result Fraction<T>::add(T leftNum, T leftDenom, T rightNum, T rightDenom) noexcept {
+    // intermediates are computed in Wide, so below 128 bits only a result that does not fit in T overflows
+    Wide sum;
+    if (leftDenom == rightDenom) {
+        if (__builtin_add_overflow(Wide(leftNum), Wide(rightNum), &sum)) {
+            return unexpected(FractionError::Overflow);
+        }
+        return normalize(magnitude(sum), UW(leftDenom), sum < 0);
+    }
+
+    // divide out the common factor of the denominators before cross-multiplying (Knuth 4.5.1)
+    U factor = gcd(U(leftDenom), U(rightDenom));
+    Wide leftScale = Wide(U(rightDenom) / factor);
+    Wide rightScale = Wide(U(leftDenom) / factor);
+    Wide leftCross, rightCross;
+    if (__builtin_mul_overflow(Wide(leftNum), leftScale, &leftCross) || __builtin_mul_overflow(Wide(rightNum), rightScale, &rightCross) ||
+        __builtin_add_overflow(leftCross, rightCross, &sum)) {
+        return unexpected(FractionError::Overflow);
+    }
+
+    // any common factor of the sum and the new denominator divides factor, which is usually 1
+    U factor2 = (factor == 1) ? 1 : gcd(U(magnitude(sum) % factor), factor);
+    Wide denom;
+    if (__builtin_mul_overflow(rightScale, Wide(U(rightDenom) / factor2), &denom)) {
+        return unexpected(FractionError::Overflow);
+    }
+    return fromMagnitudes(magnitude(sum) / factor2, UW(denom), sum < 0);
+}
+
+template <typename T>
+constexpr typename Fraction<T>::Result Fraction<T>::multiply(T leftNum, T leftDenom, T rightNum, T rightDenom) noexcept {
+    if ((leftNum == 0) || (rightNum == 0)) {
+        return Fraction();
+    }
+
+    // cross-cancel before multiplying, the products are then already in lowest terms
+    bool negative = (leftNum < 0) ^ (leftDenom < 0) ^ (rightNum < 0) ^ (rightDenom < 0);
+    U leftFactor = gcd(magnitude(leftNum), magnitude(rightDenom));
+    U rightFactor = gcd(magnitude(rightNum), magnitude(leftDenom));
+
+    U num, denom;
+    if (__builtin_mul_overflow(magnitude(leftNum) / leftFactor, magnitude(rightNum) / rightFactor, &num) ||
+        __builtin_mul_overflow(magnitude(leftDenom) / rightFactor, magnitude(rightDenom) / leftFactor, &denom)) {
+        return unexpected(FractionError::Overflow);
+    }
+
+    return fromMagnitudes(num, denom, negative);
+}
+
+template <typename T>
+constexpr strong_ordering Fraction<T>::compare(const Fraction &left, const Fraction &right) {
+    // denominators are positive, so left < right exactly when left.num * right.denom < right.num * left.denom
+    if constexpr (sizeof(T) <= sizeof(int32_t)) {
+        return int64_t(left.num) * right.denom <=> int64_t(right.num) * left.denom;
+    } else if constexpr (sizeof(T) <= sizeof(int64_t)) {
+        return __int128(left.num) * right.denom <=> __int128(right.num) * left.denom;
+    } else {
+        // no wider built-in type, compare signs and then the double-width magnitudes
+        bool leftNegative = left.num < 0;
+        bool rightNegative = right.num < 0;
+        if (leftNegative != rightNegative) {
+            return leftNegative ? strong_ordering::less : strong_ordering::greater;
+        }
+
+        U leftHigh, leftLow, rightHigh, rightLow;
+        multiplyWide(magnitude(left.num), U(right.denom), leftHigh, leftLow);
+        multiplyWide(magnitude(right.num), U(left.denom), rightHigh, rightLow);
+        strong_ordering order = (leftHigh != rightHigh) ? (leftHigh <=> rightHigh) : (leftLow <=> rightLow);
+        return leftNegative ? (0 <=> order) : order;
+    }
+}
+
+template <typename T>
+constexpr Fraction<T> &Fraction<T>::operator+=(const Fraction &right) {
+    *this = valueOrThrow(add(num, denom, right.num, right.denom));
+    return *this;
+}
+
+template <typename T>
+constexpr Fraction<T> &Fraction<T>::operator++() {
+    num = checkedAdd(num, denom);
+    return *this;
+}
+
+template <typename T>
+constexpr Fraction<T> Fraction<T>::operator++(int unused) {
+    Fraction clone = *this;
+    num = checkedAdd(num, denom);
+    return clone;
+}
+
+// common instantiations
+using Fraction32 = Fraction<int32_t>;
+using Fraction64 = Fraction<int64_t>;
+using Fraction128 = Fraction<__int128>;
+
+// 64-bit hash of a fraction, fractions are always normalized so equal values hash equally
+template <typename T>
+constexpr uint64_t fractionHash(const Fraction<T> &fraction) {
+    // fold each part to 64 bits, then mix so that every input bit reaches every output bit
+    auto fold = [](T value) {
+        using U = make_unsigned_t<T>;
+        if constexpr (sizeof(T) > sizeof(uint64_t)) {
+            return uint64_t(U(value)) ^ (uint64_t(U(value) >> 64) * 0xC2B2AE3D27D4EB4FULL);
+        } else {
+            return uint64_t(U(value));
+        }
+    };
+
+    uint64_t hash = fold(fraction.numerator()) * 0x9E3779B97F4A7C15ULL ^ fold(fraction.denominator());
+    hash ^= hash >> 32;
+    hash *= 0xD6E8FEB86659FD93ULL;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+template <typename T>
+struct std::hash<Fraction<T>> {
+    size_t operator()(const Fraction<T> &fraction) const noexcept {
+        return size_t(fractionHash(fraction));
+    }
 };
 
 // function that checks if a string only contains digits zero to nine inclusive
-bool digitCheck(string input);
+bool digitCheck(string_view input);
 
-// binary operators:
+// writes the decimal form of value ending at bufferEnd and returns a pointer to its first character
+template <typename T>
+constexpr char *formatInteger(char *bufferEnd, T value) {
+    make_unsigned_t<T> digits = magnitude(value);
+    do {
+        *--bufferEnd = char('0' + digits % 10);
+        digits /= 10;
+    } while (digits != 0);
 
-ostream &operator<<(ostream &out, const Fraction &fraction); // << operator overloading
-istream &operator>>(istream &in, Fraction &fraction); // >> operator overloading
+    if (value < 0) {
+        *--bufferEnd = '-';
+    }
+    return bufferEnd;
+}
 
-Fraction operator+(const Fraction &left, const Fraction &right); // + operator overloading
-Fraction operator-(const Fraction &left, const Fraction &right); // - (subtraction) operator overloading
-Fraction operator*(const Fraction &left, const Fraction &right); // * operator overloading
-Fraction operator/(const Fraction &left, const Fraction &right); // / operator overloading
-Fraction operator-(const Fraction &fraction); // - (negation) operator overloading
+// converts a non-empty string of digits to T, invalid characters are reported ahead of overflow
+template <typename T>
+constexpr expected<T, FractionError> tryParseInteger(string_view digits) noexcept {
+    if (digits.empty()) {
+        return unexpected(FractionError::InvalidInput);
+    }
 
-bool operator==(const Fraction &left, const Fraction &right); // == operator overloading
-bool operator!=(const Fraction &left, const Fraction &right); // != operator overloading
-bool operator<(const Fraction &left, const Fraction &right); // < operator overloading
-bool operator<=(const Fraction &left, const Fraction &right); // <= operator overloading
-bool operator>(const Fraction &left, const Fraction &right); // > operator overloading
-bool operator>=(const Fraction &left, const Fraction &right); // >= operator overloading
+    T value = 0;
+    bool overflow = false;
+    for (char digit : digits) {
+        if ((digit < '0') || (digit > '9')) {
+            return unexpected(FractionError::InvalidInput);
+        }
+        overflow |= __builtin_mul_overflow(value, T(10), &value) | __builtin_add_overflow(value, T(digit - '0'), &value);
+    }
 
-class FractionException {
-public:
-    FractionException(const string &message); // constructor
-    string what() const; // error message return method
+    if (overflow) {
+        return unexpected(FractionError::Overflow);
+    }
+    return value;
+}
 
-private:
-    string errorMessage; // error message
-};
\ No newline at end of file
+// converts a string of digits to T, throws FractionException if the value does not fit
+template <typename T>
+constexpr T parseInteger(string_view digits) {
+    return valueOrThrow(tryParseInteger<T>(digits));
+}
+
+// non-throwing parse of an "x/y" or integer token of digits, the errors match operator>>
+template <typename T>
+constexpr expected<Fraction<T>, FractionError> parseFraction(string_view input) noexcept {
+    size_t found = input.find('/');
+    expected<T, FractionError> num = tryParseInteger<T>(input.substr(0, found));
+
+    // handle integer input case
+    if (found == string_view::npos) {
+        if (!num) {
+            return unexpected(num.error());
+        }
+        return Fraction<T>(*num);
+    }
+
+    // handle '/' input case
+    expected<T, FractionError> denom = tryParseInteger<T>(input.substr(found + 1));
+    if (!num || !denom) {
+        bool invalid = (!num && (num.error() == FractionError::InvalidInput)) || (!denom && (denom.error() == FractionError::InvalidInput));
+        return unexpected(invalid ? FractionError::InvalidInput : FractionError::Overflow);
+    }
+    return Fraction<T>::create(*num, *denom);
+}
+
+// stream operators:
+
+template <typename T>
+ostream &operator<<(ostream &out, const Fraction<T> &fraction) { // << operator overloading
+    char buffer[2 * numeric_limits<T>::digits10 + 8];
+    char *end = buffer + sizeof(buffer);
+    char *start = formatInteger(end, fraction.denominator());
+    *--start = '/';
+    start = formatInteger(start, fraction.numerator());
+    out.write(start, end - start);
+    return out;
+}
+
+template <typename T>
+istream &operator>>(istream &in, Fraction<T> &fraction) { // >> operator overloading
+    string input;
+    in.clear();
+    in >> input;
+    fraction = valueOrThrow(parseFraction<T>(input));
+    return in;
+}
@@ -0,0 +1,300 @@
+/*
+File: fractionExpression.h
+Author: Logan Copeland
+Description: Compiled arithmetic expressions over fractions
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cctype>
+
+#include "fractionCalculator.h"
+
+using namespace std;
+
+// An expression such as "(a + 1/2) * -b" parsed once into postfix bytecode with constant
+// subexpressions folded, then evaluated any number of times against different variable values.
+// Supports integers, named variables, parentheses, + - * / and unary minus.
+template <typename T = int>
+class FractionExpression {
+public:
+    FractionExpression(string_view source); // constructor, throws FractionException("Invalid expression!") on a syntax error
+
+    const vector<string> &variables() const; // variable names in the order evaluate() expects their values
+    size_t variableIndex(string_view name) const; // position of name in variables(), throws if it is not used
+    size_t size() const; // number of instructions after folding
+
+    Fraction<T> evaluate(const Fraction<T> *values) const; // values[i] is the value of variables()[i]
+    Fraction<T> evaluate(const vector<Fraction<T>> &values) const;
+
+private:
+    enum class OpCode : uint8_t {
+        Constant, // push constants[operand]
+        Variable, // push values[operand]
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Negate
+    };
+
+    struct Instruction {
+        OpCode op;
+        uint32_t operand; // constant or variable index
+    };
+
+    vector<Instruction> code; // postfix program
+    vector<Fraction<T>> constants; // literal and folded values
+    vector<string> names; // variable names by slot
+    size_t maxDepth; // deepest evaluation stack the program needs
+
+    // recursive descent parser state
+    string_view source;
+    size_t position;
+
+    void parseSum();
+    void parseProduct();
+    void parseUnary();
+    void parsePrimary();
+    void skipSpaces();
+    bool accept(char expected);
+    void emitConstant(const Fraction<T> &value);
+    void emitBinary(OpCode op);
+    void computeDepth();
+
+    static Fraction<T> apply(OpCode op, const Fraction<T> &left, const Fraction<T> &right);
+};
+
+template <typename T>
+FractionExpression<T>::FractionExpression(string_view source) : maxDepth(0), source(source), position(0) {
+    parseSum();
+    skipSpaces();
+    if (position != source.length()) {
+        throw FractionException("Invalid expression!");
+    }
+    computeDepth();
+
+    // the source text is only borrowed while compiling
+    this->source = string_view();
+}
+
+template <typename T>
+const vector<string> &FractionExpression<T>::variables() const {
+    return names;
+}
+
+template <typename T>
+size_t FractionExpression<T>::variableIndex(string_view name) const {
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) {
+            return i;
+        }
+    }
+    throw FractionException("Unknown variable " + string(name) + "!");
+}
+
+template <typename T>
+size_t FractionExpression<T>::size() const {
+    return code.size();
+}
+
+template <typename T>
+void FractionExpression<T>::skipSpaces() {
+    while (position < source.length() && isspace((unsigned char)source[position])) {
+        position++;
+    }
+}
+
+template <typename T>
+bool FractionExpression<T>::accept(char expected) {
+    skipSpaces();
+    if (position < source.length() && source[position] == expected) {
+        position++;
+        return true;
+    }
+    return false;
+}
+
+// sum := product (('+' | '-') product)*
+template <typename T>
+void FractionExpression<T>::parseSum() {
+    parseProduct();
+    while (true) {
+        if (accept('+')) {
+            parseProduct();
+            emitBinary(OpCode::Add);
+        } else if (accept('-')) {
+            parseProduct();
+            emitBinary(OpCode::Subtract);
+        } else {
+            return;
+        }
+    }
+}
+
+// product := unary (('*' | '/') unary)*
+template <typename T>
+void FractionExpression<T>::parseProduct() {
+    parseUnary();
+    while (true) {
+        if (accept('*')) {
+            parseUnary();
+            emitBinary(OpCode::Multiply);
+        } else if (accept('/')) {
+            parseUnary();
+            emitBinary(OpCode::Divide);
+        } else {
+            return;
+        }
+    }
+}
+
+// unary := '-' unary | primary
+template <typename T>
+void FractionExpression<T>::parseUnary() {
+    if (!accept('-')) {
+        parsePrimary();
+        return;
+    }
+
+    parseUnary();
+    if (code.back().op == OpCode::Constant) {
+        // fold negated constants
+        constants[code.back().operand] = -constants[code.back().operand];
+    } else {
+        code.push_back({OpCode::Negate, 0});
+    }
+}
+
+// primary := integer | name | '(' sum ')'
+template <typename T>
+void FractionExpression<T>::parsePrimary() {
+    skipSpaces();
+    if (position >= source.length()) {
+        throw FractionException("Invalid expression!");
+    }
+
+    char next = source[position];
+    if (accept('(')) {
+        parseSum();
+        if (!accept(')')) {
+            throw FractionException("Invalid expression!");
+        }
+    } else if (isdigit((unsigned char)next)) {
+        size_t start = position;
+        while (position < source.length() && isdigit((unsigned char)source[position])) {
+            position++;
+        }
+        emitConstant(Fraction<T>(parseInteger<T>(source.substr(start, position - start))));
+    } else if (isalpha((unsigned char)next) || next == '_') {
+        size_t start = position;
+        while (position < source.length() && (isalnum((unsigned char)source[position]) || source[position] == '_')) {
+            position++;
+        }
+        string_view name = source.substr(start, position - start);
+
+        // each distinct name gets one slot, in order of first use
+        size_t slot = 0;
+        while (slot < names.size() && names[slot] != name) {
+            slot++;
+        }
+        if (slot == names.size()) {
+            names.emplace_back(name);
+        }
+        code.push_back({OpCode::Variable, uint32_t(slot)});
+    } else {
+        throw FractionException("Invalid expression!");
+    }
+}
+
+template <typename T>
+void FractionExpression<T>::emitConstant(const Fraction<T> &value) {
+    code.push_back({OpCode::Constant, uint32_t(constants.size())});
+    constants.push_back(value);
+}
+
+template <typename T>
+void FractionExpression<T>::emitBinary(OpCode op) {
+    // in postfix form both operands are single instructions exactly when both are constants
+    size_t size = code.size();
+    if (code[size - 2].op == OpCode::Constant && code[size - 1].op == OpCode::Constant) {
+        Fraction<T> folded = apply(op, constants[code[size - 2].operand], constants[code[size - 1].operand]);
+        constants[code[size - 2].operand] = folded;
+        constants.pop_back(); // the right operand is always the most recent constant
+        code.pop_back();
+    } else {
+        code.push_back({op, 0});
+    }
+}
+
+template <typename T>
+void FractionExpression<T>::computeDepth() {
+    size_t depth = 0;
+    for (const Instruction &instruction : code) {
+        if (instruction.op == OpCode::Constant || instruction.op == OpCode::Variable) {
+            depth++;
+        } else if (instruction.op != OpCode::Negate) {
+            depth--;
+        }
+        maxDepth = max(maxDepth, depth);
+    }
+}
+
+template <typename T>
+Fraction<T> FractionExpression<T>::apply(OpCode op, const Fraction<T> &left, const Fraction<T> &right) {
+    switch (op) {
+    case OpCode::Add:
+        return left + right;
+    case OpCode::Subtract:
+        return left - right;
+    case OpCode::Multiply:
+        return left * right;
+    default:
+        return left / right;
+    }
+}
+
+template <typename T>
+Fraction<T> FractionExpression<T>::evaluate(const Fraction<T> *values) const {
+    // shallow programs, the common case, evaluate on a fixed stack without allocating
+    array<Fraction<T>, 32> fixedStack;
+    vector<Fraction<T>> heapStack;
+    Fraction<T> *stack = fixedStack.data();
+    if (maxDepth > fixedStack.size()) {
+        heapStack.resize(maxDepth);
+        stack = heapStack.data();
+    }
+
+    size_t top = 0;
+    for (const Instruction &instruction : code) {
+        switch (instruction.op) {
+        case OpCode::Constant:
+            stack[top++] = constants[instruction.operand];
+            break;
+        case OpCode::Variable:
+            stack[top++] = values[instruction.operand];
+            break;
+        case OpCode::Negate:
+            stack[top - 1] = -stack[top - 1];
+            break;
+        default:
+            top--;
+            stack[top - 1] = apply(instruction.op, stack[top - 1], stack[top]);
+            break;
+        }
+    }
+    return stack[0];
+}
+
+template <typename T>
+Fraction<T> FractionExpression<T>::evaluate(const vector<Fraction<T>> &values) const {
+    if (values.size() < names.size()) {
+        throw FractionException("Missing variable values!");
+    }
+    return evaluate(values.data());
+}
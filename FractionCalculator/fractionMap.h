@@ -0,0 +1,242 @@
+/*
+File: fractionMap.h
+Author: Logan Copeland
+Description: Open-addressing hash map keyed by Fraction for group-by aggregation
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+
+#include "fractionCalculator.h"
+
+using namespace std;
+
+// Maps exact fraction keys to values of type V. Keys and values live together in one contiguous
+// slot array probed linearly, with a parallel array of one-byte tags so that most probes that miss
+// never touch a slot. Entries cannot be erased, the map is meant for building up aggregates.
+template <typename V, typename T = int>
+class FractionMap {
+public:
+    FractionMap(size_t expectedSize = 0); // constructor, reserves room for expectedSize keys
+
+    size_t size() const;
+    bool empty() const;
+    void reserve(size_t expectedSize); // grows so that expectedSize keys fit without rehashing
+    void clear();
+
+    V &operator[](const Fraction<T> &key); // value for key, inserting V() if key is missing
+    V *find(const Fraction<T> &key); // value for key or nullptr
+    const V *find(const Fraction<T> &key) const;
+    bool contains(const Fraction<T> &key) const;
+
+    // inserts value for a new key, or calls combine(existing, value) for a key already present
+    template <typename Combine>
+    void accumulate(const Fraction<T> &key, const V &value, Combine combine);
+    void accumulate(const Fraction<T> &key, const V &value); // combines with +=
+
+    // accumulate for every keys[i], values[i] pair, hashing and prefetching a block of keys ahead of the inserts
+    template <typename Combine>
+    void accumulate(const Fraction<T> *keys, const V *values, size_t numKeys, Combine combine);
+    void accumulate(const vector<Fraction<T>> &keys, const vector<V> &values); // combines with +=, throws if the sizes differ
+
+    // calls function(key, value) for every entry, in no particular order
+    template <typename Function>
+    void forEach(Function function) const;
+
+private:
+    struct Slot {
+        Fraction<T> key;
+        V value;
+    };
+
+    static constexpr uint8_t emptyTag = 0; // tags of used slots always have the high bit set
+    static constexpr size_t minCapacity = 16;
+    static constexpr size_t blockSize = 32; // keys hashed ahead by the bulk accumulate
+
+    vector<uint8_t> tags; // emptyTag or 0x80 | the top 7 hash bits of the key in the slot
+    vector<Slot> slots;
+    size_t count; // number of keys
+    size_t mask; // capacity - 1, the capacity is a power of two
+
+    static uint8_t tagOf(uint64_t hash);
+    size_t findSlot(const Fraction<T> &key, uint64_t hash) const; // slot holding key, or the empty slot where it belongs
+    void growFor(size_t extraKeys); // keeps the load at or below 3/4 after extraKeys more inserts
+    void rehash(size_t capacity);
+    template <typename Combine>
+    void accumulateHashed(const Fraction<T> &key, uint64_t hash, const V &value, Combine combine);
+};
+
+template <typename V, typename T>
+FractionMap<V, T>::FractionMap(size_t expectedSize) : count(0), mask(0) {
+    rehash(minCapacity);
+    reserve(expectedSize);
+}
+
+template <typename V, typename T>
+size_t FractionMap<V, T>::size() const {
+    return count;
+}
+
+template <typename V, typename T>
+bool FractionMap<V, T>::empty() const {
+    return count == 0;
+}
+
+template <typename V, typename T>
+void FractionMap<V, T>::reserve(size_t expectedSize) {
+    growFor(expectedSize > count ? expectedSize - count : 0);
+}
+
+template <typename V, typename T>
+void FractionMap<V, T>::clear() {
+    fill(tags.begin(), tags.end(), emptyTag);
+    count = 0;
+}
+
+template <typename V, typename T>
+uint8_t FractionMap<V, T>::tagOf(uint64_t hash) {
+    return uint8_t(0x80 | (hash >> 57));
+}
+
+template <typename V, typename T>
+size_t FractionMap<V, T>::findSlot(const Fraction<T> &key, uint64_t hash) const {
+    uint8_t tag = tagOf(hash);
+    size_t index = size_t(hash) & mask;
+    while (tags[index] != emptyTag) {
+        if ((tags[index] == tag) && (slots[index].key == key)) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+template <typename V, typename T>
+void FractionMap<V, T>::growFor(size_t extraKeys) {
+    size_t capacity = mask + 1;
+    while ((count + extraKeys) * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+    if (capacity != mask + 1) {
+        rehash(capacity);
+    }
+}
+
+template <typename V, typename T>
+void FractionMap<V, T>::rehash(size_t capacity) {
+    vector<uint8_t> oldTags(capacity, emptyTag);
+    vector<Slot> oldSlots(capacity);
+    oldTags.swap(tags);
+    oldSlots.swap(slots);
+    mask = capacity - 1;
+
+    for (size_t i = 0; i < oldTags.size(); i++) {
+        if (oldTags[i] != emptyTag) {
+            size_t index = findSlot(oldSlots[i].key, fractionHash(oldSlots[i].key));
+            tags[index] = oldTags[i];
+            slots[index] = move(oldSlots[i]);
+        }
+    }
+}
+
+template <typename V, typename T>
+V &FractionMap<V, T>::operator[](const Fraction<T> &key) {
+    growFor(1);
+    uint64_t hash = fractionHash(key);
+    size_t index = findSlot(key, hash);
+    if (tags[index] == emptyTag) {
+        tags[index] = tagOf(hash);
+        slots[index].key = key;
+        slots[index].value = V();
+        count++;
+    }
+    return slots[index].value;
+}
+
+template <typename V, typename T>
+V *FractionMap<V, T>::find(const Fraction<T> &key) {
+    size_t index = findSlot(key, fractionHash(key));
+    return (tags[index] == emptyTag) ? nullptr : &slots[index].value;
+}
+
+template <typename V, typename T>
+const V *FractionMap<V, T>::find(const Fraction<T> &key) const {
+    size_t index = findSlot(key, fractionHash(key));
+    return (tags[index] == emptyTag) ? nullptr : &slots[index].value;
+}
+
+template <typename V, typename T>
+bool FractionMap<V, T>::contains(const Fraction<T> &key) const {
+    return find(key) != nullptr;
+}
+
+template <typename V, typename T>
+template <typename Combine>
+void FractionMap<V, T>::accumulateHashed(const Fraction<T> &key, uint64_t hash, const V &value, Combine combine) {
+    size_t index = findSlot(key, hash);
+    if (tags[index] == emptyTag) {
+        tags[index] = tagOf(hash);
+        slots[index].key = key;
+        slots[index].value = value;
+        count++;
+    } else {
+        combine(slots[index].value, value);
+    }
+}
+
+template <typename V, typename T>
+template <typename Combine>
+void FractionMap<V, T>::accumulate(const Fraction<T> &key, const V &value, Combine combine) {
+    growFor(1);
+    accumulateHashed(key, fractionHash(key), value, combine);
+}
+
+template <typename V, typename T>
+void FractionMap<V, T>::accumulate(const Fraction<T> &key, const V &value) {
+    accumulate(key, value, [](V &total, const V &term) { total += term; });
+}
+
+template <typename V, typename T>
+template <typename Combine>
+void FractionMap<V, T>::accumulate(const Fraction<T> *keys, const V *values, size_t numKeys, Combine combine) {
+    uint64_t hashes[blockSize];
+    for (size_t first = 0; first < numKeys; first += blockSize) {
+        size_t last = min(numKeys, first + blockSize);
+
+        // the capacity must not change within a block, the prefetched positions depend on it
+        growFor(last - first);
+
+        // hash the whole block and start loading its slots before any probe waits on memory
+        for (size_t i = first; i < last; i++) {
+            hashes[i - first] = fractionHash(keys[i]);
+            size_t index = size_t(hashes[i - first]) & mask;
+            __builtin_prefetch(&tags[index]);
+            __builtin_prefetch(&slots[index]);
+        }
+        for (size_t i = first; i < last; i++) {
+            accumulateHashed(keys[i], hashes[i - first], values[i], combine);
+        }
+    }
+}
+
+template <typename V, typename T>
+void FractionMap<V, T>::accumulate(const vector<Fraction<T>> &keys, const vector<V> &values) {
+    if (keys.size() != values.size()) {
+        throw FractionException("Size mismatch!");
+    }
+    accumulate(keys.data(), values.data(), keys.size(), [](V &total, const V &term) { total += term; });
+}
+
+template <typename V, typename T>
+template <typename Function>
+void FractionMap<V, T>::forEach(Function function) const {
+    for (size_t i = 0; i < tags.size(); i++) {
+        if (tags[i] != emptyTag) {
+            function(slots[i].key, slots[i].value);
+        }
+    }
+}
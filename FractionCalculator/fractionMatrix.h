@@ -0,0 +1,475 @@
+/*
+File: fractionMatrix.h
+Author: Logan Copeland
+Description: Exact linear algebra over fractions using fraction-free Bareiss elimination
+*/
+
+#pragma once
+
+#include <vector>
+#include <future>
+#include <algorithm>
+#include <exception>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+
+#include "fractionCalculator.h"
+#include "bigFraction.h"
+#include "threadPool.h"
+
+using namespace std;
+
+// Dense row-major matrix of Fraction<T> values. Determinant, rank, solve and inverse scale
+// each row to integers and run Bareiss elimination, in which every intermediate value is a
+// minor of the scaled matrix and every division is exact, so no gcd is taken until the results
+// are normalized at the end. The elimination first runs in checked __int128 arithmetic and is
+// repeated in BigInteger only if an intermediate value overflows, so only results that do not
+// fit in T throw FractionException("Overflow!"). Row updates below each pivot are split across
+// pool workers once the matrix is large enough.
+template <typename T = int>
+class FractionMatrix {
+    static_assert(sizeof(T) <= sizeof(int64_t), "FractionMatrix supports integer types up to 64 bits");
+
+public:
+    FractionMatrix(size_t rows, size_t columns); // constructor, all entries zero
+    FractionMatrix(size_t rows, size_t columns, const vector<Fraction<T>> &values); // constructor from row-major values, throws if the size differs
+    static FractionMatrix identity(size_t size);
+
+    size_t rows() const;
+    size_t columns() const;
+    Fraction<T> &operator()(size_t row, size_t column); // element access
+    const Fraction<T> &operator()(size_t row, size_t column) const;
+    const vector<Fraction<T>> &values() const; // row-major entries
+
+    friend bool operator==(const FractionMatrix &left, const FractionMatrix &right) { // == operator overloading
+        return (left.numRows == right.numRows) && (left.numColumns == right.numColumns) && (left.entries == right.entries);
+    }
+
+    friend bool operator!=(const FractionMatrix &left, const FractionMatrix &right) { // != operator overloading
+        return !(left == right);
+    }
+
+    // throw FractionException("Size mismatch!") for a non-square matrix or a wrongly sized right hand side,
+    // and solve() and inverse() throw FractionException("Undefined!") for a singular matrix
+    Fraction<T> determinant(ThreadPool &pool = ThreadPool::shared()) const;
+    size_t rank(ThreadPool &pool = ThreadPool::shared()) const;
+    vector<Fraction<T>> solve(const vector<Fraction<T>> &rightSide, ThreadPool &pool = ThreadPool::shared()) const; // x with A x = rightSide
+    FractionMatrix inverse(ThreadPool &pool = ThreadPool::shared()) const;
+
+private:
+    // scaled integer form of the matrix with extra columns appended on the right
+    template <typename Integer>
+    struct IntegerMatrix {
+        size_t rows;
+        size_t width;
+        vector<Integer> cells; // row-major
+        vector<Integer> scales; // row i of the fraction matrix was multiplied by scales[i]
+
+        Integer &at(size_t row, size_t column) {
+            return cells[row * width + column];
+        }
+    };
+
+    struct IntegerOverflow {}; // thrown by the __int128 arithmetic below to restart in BigInteger
+
+    static constexpr size_t minParallelCells = 1 << 14; // smaller elimination steps are not worth a task each
+
+    size_t numRows; // number of rows
+    size_t numColumns; // number of columns
+    vector<Fraction<T>> entries; // row-major values
+
+    void checkSquare() const;
+    template <typename Function>
+    auto withIntegerForm(const FractionMatrix *extra, Function function) const;
+    template <typename Integer>
+    void buildIntegerForm(const FractionMatrix *extra, IntegerMatrix<Integer> &matrix) const;
+    static double hadamardBits(const IntegerMatrix<__int128> &matrix); // log2 of a bound on the magnitude of every minor
+    template <typename Integer>
+    static size_t bareiss(IntegerMatrix<Integer> &matrix, size_t pivotColumns, bool &negated, ThreadPool &pool);
+    template <typename Integer>
+    static vector<BigInteger> backSubstitute(IntegerMatrix<Integer> &matrix, size_t column);
+    static Fraction<T> toFraction(const BigInteger &num, const BigInteger &denom);
+
+    // overloads that let the elimination run on either integer representation
+    static bool isZero(__int128 value);
+    static bool isZero(const BigInteger &value);
+    static __int128 multiply(__int128 x, __int128 y); // throws IntegerOverflow
+    static BigInteger multiply(const BigInteger &x, const BigInteger &y);
+    static __int128 subtract(__int128 x, __int128 y); // throws IntegerOverflow
+    static BigInteger subtract(const BigInteger &x, const BigInteger &y);
+    static __int128 divide(__int128 x, __int128 y); // exact division, throws IntegerOverflow
+    static BigInteger divide(const BigInteger &x, const BigInteger &y);
+    static __int128 gcd(__int128 x, __int128 y);
+    static BigInteger gcd(const BigInteger &x, const BigInteger &y);
+};
+
+template <typename T>
+FractionMatrix<T>::FractionMatrix(size_t rows, size_t columns) : numRows(rows), numColumns(columns), entries(rows * columns) {}
+
+template <typename T>
+FractionMatrix<T>::FractionMatrix(size_t rows, size_t columns, const vector<Fraction<T>> &values)
+    : numRows(rows), numColumns(columns), entries(values) {
+    if (values.size() != rows * columns) {
+        throw FractionException("Size mismatch!");
+    }
+}
+
+template <typename T>
+FractionMatrix<T> FractionMatrix<T>::identity(size_t size) {
+    FractionMatrix result(size, size);
+    for (size_t i = 0; i < size; i++) {
+        result(i, i) = 1;
+    }
+    return result;
+}
+
+template <typename T>
+size_t FractionMatrix<T>::rows() const {
+    return numRows;
+}
+
+template <typename T>
+size_t FractionMatrix<T>::columns() const {
+    return numColumns;
+}
+
+template <typename T>
+Fraction<T> &FractionMatrix<T>::operator()(size_t row, size_t column) {
+    return entries[row * numColumns + column];
+}
+
+template <typename T>
+const Fraction<T> &FractionMatrix<T>::operator()(size_t row, size_t column) const {
+    return entries[row * numColumns + column];
+}
+
+template <typename T>
+const vector<Fraction<T>> &FractionMatrix<T>::values() const {
+    return entries;
+}
+
+template <typename T>
+void FractionMatrix<T>::checkSquare() const {
+    if (numRows != numColumns) {
+        throw FractionException("Size mismatch!");
+    }
+}
+
+template <typename T>
+bool FractionMatrix<T>::isZero(__int128 value) {
+    return value == 0;
+}
+
+template <typename T>
+bool FractionMatrix<T>::isZero(const BigInteger &value) {
+    return value.isZero();
+}
+
+template <typename T>
+__int128 FractionMatrix<T>::multiply(__int128 x, __int128 y) {
+    __int128 result;
+    if (__builtin_mul_overflow(x, y, &result)) {
+        throw IntegerOverflow();
+    }
+    return result;
+}
+
+template <typename T>
+BigInteger FractionMatrix<T>::multiply(const BigInteger &x, const BigInteger &y) {
+    return x * y;
+}
+
+template <typename T>
+__int128 FractionMatrix<T>::subtract(__int128 x, __int128 y) {
+    __int128 result;
+    if (__builtin_sub_overflow(x, y, &result)) {
+        throw IntegerOverflow();
+    }
+    return result;
+}
+
+template <typename T>
+BigInteger FractionMatrix<T>::subtract(const BigInteger &x, const BigInteger &y) {
+    return x - y;
+}
+
+template <typename T>
+__int128 FractionMatrix<T>::divide(__int128 x, __int128 y) {
+    // the only quotient that does not fit
+    if ((y == -1) && (x == numeric_limits<__int128>::min())) {
+        throw IntegerOverflow();
+    }
+    return x / y;
+}
+
+template <typename T>
+BigInteger FractionMatrix<T>::divide(const BigInteger &x, const BigInteger &y) {
+    return x / y;
+}
+
+template <typename T>
+__int128 FractionMatrix<T>::gcd(__int128 x, __int128 y) {
+    return __int128(binaryGcd(magnitude(x), magnitude(y)));
+}
+
+template <typename T>
+BigInteger FractionMatrix<T>::gcd(const BigInteger &x, const BigInteger &y) {
+    return ::gcd(x, y);
+}
+
+template <typename T>
+template <typename Integer>
+void FractionMatrix<T>::buildIntegerForm(const FractionMatrix *extra, IntegerMatrix<Integer> &matrix) const {
+    size_t extraColumns = (extra != nullptr) ? extra->numColumns : 0;
+    matrix.rows = numRows;
+    matrix.width = numColumns + extraColumns;
+    matrix.cells.assign(matrix.rows * matrix.width, Integer(0));
+    matrix.scales.assign(numRows, Integer(1));
+
+    for (size_t row = 0; row < numRows; row++) {
+        auto entry = [&](size_t column) -> const Fraction<T> & {
+            return (column < numColumns) ? (*this)(row, column) : (*extra)(row, column - numColumns);
+        };
+
+        // the least common multiple of the row's denominators clears them all
+        Integer &scale = matrix.scales[row];
+        for (size_t column = 0; column < matrix.width; column++) {
+            Integer denom = Integer(entry(column).denominator());
+            scale = multiply(scale / gcd(scale, denom), denom);
+        }
+        for (size_t column = 0; column < matrix.width; column++) {
+            matrix.at(row, column) = multiply(Integer(entry(column).numerator()), scale / Integer(entry(column).denominator()));
+        }
+    }
+}
+
+template <typename T>
+double FractionMatrix<T>::hadamardBits(const IntegerMatrix<__int128> &matrix) {
+    // |minor| <= product of the lengths of its rows, and a row of a minor is never longer than the full row
+    double bits = 0;
+    for (size_t row = 0; row < matrix.rows; row++) {
+        long double squares = 0;
+        for (size_t column = 0; column < matrix.width; column++) {
+            long double value = (long double)matrix.cells[row * matrix.width + column];
+            squares += value * value;
+        }
+        bits += 0.5 * log2(max(squares, 1.0L));
+    }
+    return bits;
+}
+
+template <typename T>
+template <typename Function>
+auto FractionMatrix<T>::withIntegerForm(const FractionMatrix *extra, Function function) const {
+    // most inputs never leave __int128, redoing the work in BigInteger is cheaper than always using it,
+    // unless the bound is so large that the final minors will almost certainly overflow (the bound
+    // typically overestimates a determinant by about half a bit per row)
+    try {
+        IntegerMatrix<__int128> small;
+        buildIntegerForm(extra, small);
+        if (hadamardBits(small) < 126 + 0.5 * double(numRows)) {
+            return function(small);
+        }
+    } catch (IntegerOverflow &overflow) {
+    }
+
+    IntegerMatrix<BigInteger> big;
+    buildIntegerForm(extra, big);
+    return function(big);
+}
+
+template <typename T>
+template <typename Integer>
+size_t FractionMatrix<T>::bareiss(IntegerMatrix<Integer> &matrix, size_t pivotColumns, bool &negated, ThreadPool &pool) {
+    Integer previous = 1; // pivot of the previous step, divides every updated cell exactly
+    size_t pivotRow = 0;
+    negated = false;
+
+    for (size_t column = 0; (column < pivotColumns) && (pivotRow < matrix.rows); column++) {
+        size_t found = pivotRow;
+        while ((found < matrix.rows) && isZero(matrix.at(found, column))) {
+            found++;
+        }
+        if (found == matrix.rows) {
+            continue;
+        }
+        if (found != pivotRow) {
+            swap_ranges(matrix.cells.begin() + found * matrix.width, matrix.cells.begin() + (found + 1) * matrix.width,
+                        matrix.cells.begin() + pivotRow * matrix.width);
+            negated = !negated;
+        }
+
+        // every row below the pivot is updated independently from the pivot row, each task gets its
+        // own copy of the pivots
+        Integer pivot = matrix.at(pivotRow, column);
+        auto updateRows = [&matrix, previous, pivot, pivotRow, column](size_t first, size_t last) {
+            for (size_t row = first; row < last; row++) {
+                Integer factor = matrix.at(row, column);
+                bool zeroFactor = isZero(factor);
+                for (size_t j = column + 1; j < matrix.width; j++) {
+                    Integer &cell = matrix.at(row, j);
+                    Integer scaled = multiply(pivot, cell);
+                    if (!zeroFactor) {
+                        scaled = subtract(scaled, multiply(factor, matrix.at(pivotRow, j)));
+                    }
+                    cell = divide(scaled, previous);
+                }
+                matrix.at(row, column) = 0;
+            }
+        };
+
+        size_t firstRow = pivotRow + 1;
+        size_t numUpdated = matrix.rows - firstRow;
+        unsigned numTasks = unsigned(min(size_t(pool.size()), numUpdated * (matrix.width - column) / minParallelCells));
+        if (numTasks <= 1) {
+            updateRows(firstRow, matrix.rows);
+        } else {
+            vector<future<void>> workers;
+            for (unsigned i = 0; i < numTasks; i++) {
+                size_t first = firstRow + numUpdated * i / numTasks;
+                size_t last = firstRow + numUpdated * (i + 1) / numTasks;
+                workers.push_back(pool.submit([updateRows, first, last]() {
+                    updateRows(first, last);
+                }));
+            }
+
+            // wait for every task before rethrowing an overflow, the tasks still write to matrix
+            exception_ptr error;
+            for (future<void> &worker : workers) {
+                try {
+                    worker.get();
+                } catch (...) {
+                    if (!error) {
+                        error = current_exception();
+                    }
+                }
+            }
+            if (error) {
+                rethrow_exception(error);
+            }
+        }
+
+        previous = pivot;
+        pivotRow++;
+    }
+    return pivotRow;
+}
+
+template <typename T>
+template <typename Integer>
+vector<BigInteger> FractionMatrix<T>::backSubstitute(IntegerMatrix<Integer> &matrix, size_t column) {
+    // after full rank elimination the last pivot d is the determinant of the scaled matrix up to sign,
+    // so by Cramer's rule every d * x[i] is an integer and each division below is exact
+    size_t size = matrix.rows;
+    Integer d = matrix.at(size - 1, size - 1);
+    vector<Integer> scaled(size);
+    for (size_t i = size; i-- > 0;) {
+        Integer sum = multiply(d, matrix.at(i, column));
+        for (size_t j = i + 1; j < size; j++) {
+            sum = subtract(sum, multiply(matrix.at(i, j), scaled[j]));
+        }
+        scaled[i] = divide(sum, matrix.at(i, i));
+    }
+
+    vector<BigInteger> result;
+    result.reserve(size + 1);
+    for (const Integer &value : scaled) {
+        result.push_back(BigInteger(value));
+    }
+    result.push_back(BigInteger(d)); // common denominator
+    return result;
+}
+
+template <typename T>
+Fraction<T> FractionMatrix<T>::toFraction(const BigInteger &num, const BigInteger &denom) {
+    BigFraction value(num, denom);
+    BigInteger reducedNum = value.numerator();
+    BigInteger reducedDenom = value.denominator();
+    if (!reducedNum.fitsInt64() || !reducedDenom.fitsInt64()) {
+        throw FractionException("Overflow!");
+    }
+
+    int64_t smallNum = reducedNum.toInt64();
+    int64_t smallDenom = reducedDenom.toInt64();
+    if ((smallNum < int64_t(numeric_limits<T>::min())) || (smallNum > int64_t(numeric_limits<T>::max())) ||
+        (smallDenom > int64_t(numeric_limits<T>::max()))) {
+        throw FractionException("Overflow!");
+    }
+    return Fraction<T>(T(smallNum), T(smallDenom));
+}
+
+template <typename T>
+Fraction<T> FractionMatrix<T>::determinant(ThreadPool &pool) const {
+    checkSquare();
+    if (numRows == 0) {
+        return 1;
+    }
+
+    return withIntegerForm(nullptr, [&](auto &matrix) {
+        bool negated;
+        if (bareiss(matrix, numColumns, negated, pool) < numRows) {
+            return Fraction<T>();
+        }
+
+        // det(A) = det(scaled A) / product of the row scales
+        BigInteger scaledDeterminant = BigInteger(matrix.at(numRows - 1, numRows - 1));
+        BigInteger product = 1;
+        for (const auto &scale : matrix.scales) {
+            product = product * BigInteger(scale);
+        }
+        return toFraction(negated ? -scaledDeterminant : scaledDeterminant, product);
+    });
+}
+
+template <typename T>
+size_t FractionMatrix<T>::rank(ThreadPool &pool) const {
+    return withIntegerForm(nullptr, [&](auto &matrix) {
+        bool negated;
+        return bareiss(matrix, numColumns, negated, pool);
+    });
+}
+
+template <typename T>
+vector<Fraction<T>> FractionMatrix<T>::solve(const vector<Fraction<T>> &rightSide, ThreadPool &pool) const {
+    checkSquare();
+    FractionMatrix extra(numRows, 1, rightSide);
+
+    return withIntegerForm(&extra, [&](auto &matrix) {
+        bool negated;
+        if (bareiss(matrix, numColumns, negated, pool) < numRows) {
+            throw FractionException("Undefined!");
+        }
+
+        vector<BigInteger> scaled = backSubstitute(matrix, numColumns);
+        vector<Fraction<T>> result;
+        result.reserve(numRows);
+        for (size_t i = 0; i < numRows; i++) {
+            result.push_back(toFraction(scaled[i], scaled[numRows]));
+        }
+        return result;
+    });
+}
+
+template <typename T>
+FractionMatrix<T> FractionMatrix<T>::inverse(ThreadPool &pool) const {
+    checkSquare();
+    FractionMatrix extra = identity(numRows);
+
+    return withIntegerForm(&extra, [&](auto &matrix) {
+        bool negated;
+        if (bareiss(matrix, numColumns, negated, pool) < numRows) {
+            throw FractionException("Undefined!");
+        }
+
+        // column j of the inverse solves A x = e_j
+        FractionMatrix result(numRows, numRows);
+        for (size_t j = 0; j < numRows; j++) {
+            vector<BigInteger> scaled = backSubstitute(matrix, numColumns + j);
+            for (size_t i = 0; i < numRows; i++) {
+                result(i, j) = toFraction(scaled[i], scaled[numRows]);
+            }
+        }
+        return result;
+    });
+}
@@ -0,0 +1,138 @@
+/*
+File: fractionParser.cpp
+Author: Logan Copeland
+Description: Bulk fraction parser implementation file
+*/
+
+#include "fractionParser.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+MappedFile::MappedFile(const string &path) : data(nullptr), size(0) {
+    int descriptor = open(path.c_str(), O_RDONLY);
+
+    // throw exception if file cannot be opened
+    if (descriptor < 0) {
+        throw FractionException("Unable to read " + path + "!");
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        throw FractionException("Unable to read " + path + "!");
+    }
+
+    size = size_t(status.st_size);
+    if (size > 0) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data == MAP_FAILED) {
+            close(descriptor);
+            throw FractionException("Unable to read " + path + "!");
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    close(descriptor);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+}
+
+string_view MappedFile::contents() const {
+    return string_view(static_cast<const char *>(data), size);
+}
+
+static inline bool isSpace(char character) {
+    return (character == ' ') || (character >= '\t' && character <= '\r');
+}
+
+// parses one run of digits starting at position. Every byte of the input passes through here or
+// through the whitespace and '/' checks of the token loop, so the data is only read once.
+static inline const char *parseDigits(const char *position, const char *end, int32_t &value) {
+    // an empty run of digits ('/' at the start of a token or after another '/'), or a sign, which
+    // from_chars would otherwise accept
+    if (position == end || *position < '0' || *position > '9') {
+        throw FractionException("Invalid input!");
+    }
+    from_chars_result parsed = from_chars(position, end, value);
+    if (parsed.ec == errc::result_out_of_range) {
+        throw FractionException("Overflow!");
+    }
+    return parsed.ptr;
+}
+
+// calls store(num, denom) with the raw numerator and denominator of every token in buffer
+template <typename Store>
+static void forEachToken(string_view buffer, Store store) {
+    const char *position = buffer.data();
+    const char *end = position + buffer.size();
+    while (true) {
+        while (position < end && isSpace(*position)) {
+            position++;
+        }
+        if (position == end) {
+            break;
+        }
+
+        int32_t num, denom = 1;
+        position = parseDigits(position, end, num);
+        if (position < end && *position == '/') {
+            position = parseDigits(position + 1, end, denom);
+        }
+
+        // the token has to end here, e.g. not "1/2/3" or "1x"
+        if (position < end && !isSpace(*position)) {
+            throw FractionException("Invalid input!");
+        }
+        store(num, denom);
+    }
+}
+
+void parseFractions(string_view buffer, FractionVector &result) {
+    size_t first = result.size();
+    try {
+        forEachToken(buffer, [&result](int32_t num, int32_t denom) {
+            result.push_back(num, denom);
+        });
+
+        // normalize the new values in one batch
+        FractionVector::reduce(result, first);
+    } catch (...) {
+        // leave result as it was, without the raw values of the tokens parsed so far
+        result.resize(first);
+        throw;
+    }
+}
+
+void parseFractions(string_view buffer, vector<Fraction<int32_t>> &result) {
+    size_t first = result.size();
+    try {
+        forEachToken(buffer, [&result](int32_t num, int32_t denom) {
+            result.emplace_back(num, denom);
+        });
+    } catch (...) {
+        result.erase(result.begin() + first, result.end());
+        throw;
+    }
+}
+
+void parseFractionFile(const string &path, FractionVector &result) {
+    MappedFile file(path);
+    parseFractions(file.contents(), result);
+}
+
+void parseFractionFile(const string &path, vector<Fraction<int32_t>> &result) {
+    MappedFile file(path);
+    parseFractions(file.contents(), result);
+}
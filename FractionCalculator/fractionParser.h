@@ -0,0 +1,43 @@
+/*
+File: fractionParser.h
+Author: Logan Copeland
+Description: Bulk fraction parser over memory-mapped files and in-memory buffers
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fractionCalculator.h"
+#include "fractionVector.h"
+
+using namespace std;
+
+// read-only memory mapping of a whole file, unmapped when the object is destroyed
+class MappedFile {
+public:
+    MappedFile(const string &path); // constructor, throws FractionException if the file cannot be mapped
+    ~MappedFile(); // destructor
+    MappedFile(const MappedFile &other) = delete;
+    MappedFile &operator=(const MappedFile &other) = delete;
+
+    string_view contents() const;
+
+private:
+    void *data; // start of the mapping, nullptr for an empty file
+    size_t size; // length of the file in bytes
+};
+
+// Parse whitespace separated "x/y" and integer tokens, with the same rules as operator>>, and
+// append them to result. Tokens are read in place with from_chars, nothing is allocated per token.
+// Throws FractionException("Invalid input!") if any token is malformed, "Overflow!" if a numerator or
+// denominator does not fit in 32 bits and "Undefined!" for a zero denominator. result is then left
+// unchanged.
+void parseFractions(string_view buffer, FractionVector &result);
+void parseFractions(string_view buffer, vector<Fraction<int32_t>> &result);
+
+// the same as parseFractions over the memory-mapped contents of the file at path
+void parseFractionFile(const string &path, FractionVector &result);
+void parseFractionFile(const string &path, vector<Fraction<int32_t>> &result);
@@ -0,0 +1,129 @@
+/*
+File: fractionReduce.h
+Author: Logan Copeland
+Description: Parallel sums, products and reductions over ranges of fractions
+*/
+
+#pragma once
+
+#include <vector>
+#include <future>
+#include <iterator>
+#include <algorithm>
+#include <exception>
+
+#include "fractionCalculator.h"
+#include "fractionAccumulator.h"
+#include "threadPool.h"
+
+using namespace std;
+
+// runs chunkFunction(chunkFirst, chunkLast) on one contiguous chunk of [first, last) per worker
+// and returns the chunk results in range order
+template <typename Iterator, typename ChunkFunction>
+auto mapChunks(Iterator first, Iterator last, ThreadPool &pool, ChunkFunction chunkFunction) {
+    using Result = invoke_result_t<ChunkFunction, Iterator, Iterator>;
+
+    size_t size = size_t(distance(first, last));
+    size_t minChunkSize = 4096; // smaller chunks cost more to schedule than to fold
+    size_t numChunks = max(size_t(1), min(size_t(pool.size()), size / minChunkSize));
+
+    vector<Result> results;
+    results.reserve(numChunks);
+    if (numChunks == 1) {
+        results.push_back(chunkFunction(first, last));
+        return results;
+    }
+
+    vector<future<Result>> pending;
+    for (size_t i = 0; i < numChunks; i++) {
+        Iterator chunkFirst = first + (size * i / numChunks);
+        Iterator chunkLast = first + (size * (i + 1) / numChunks);
+        pending.push_back(pool.submit([chunkFunction, chunkFirst, chunkLast]() {
+            return chunkFunction(chunkFirst, chunkLast);
+        }));
+    }
+
+    // wait for every chunk before rethrowing, so that no task still uses chunkFunction's captures
+    exception_ptr error;
+    for (future<Result> &result : pending) {
+        try {
+            results.push_back(result.get());
+        } catch (...) {
+            if (!error) {
+                error = current_exception();
+            }
+        }
+    }
+    if (error) {
+        rethrow_exception(error);
+    }
+    return results;
+}
+
+// combines neighbouring partial results pairwise, so the combination order is a balanced
+// tree over the original range order
+template <typename Value, typename Combine>
+Value combineTree(vector<Value> partials, Combine combine) {
+    for (size_t width = 1; width < partials.size(); width *= 2) {
+        for (size_t i = 0; i + width < partials.size(); i += 2 * width) {
+            partials[i] = combine(partials[i], partials[i + width]);
+        }
+    }
+    return partials[0];
+}
+
+// sum of the fractions in [first, last), equal to the serial fold with +=
+template <typename Iterator>
+auto parallelSum(Iterator first, Iterator last, ThreadPool &pool = ThreadPool::shared()) {
+    using T = typename iterator_traits<Iterator>::value_type::value_type;
+
+    // each chunk sums into an accumulator that only reduces when it nears overflow
+    vector<FractionAccumulator<T>> partials = mapChunks(first, last, pool, [](Iterator chunkFirst, Iterator chunkLast) {
+        FractionAccumulator<T> partial;
+        for (; chunkFirst != chunkLast; ++chunkFirst) {
+            partial += *chunkFirst;
+        }
+        return partial;
+    });
+
+    return combineTree(partials, [](FractionAccumulator<T> left, const FractionAccumulator<T> &right) {
+        return left += right;
+    }).result();
+}
+
+// product of the fractions in [first, last), equal to the serial fold with *
+template <typename Iterator>
+auto parallelProduct(Iterator first, Iterator last, ThreadPool &pool = ThreadPool::shared()) {
+    using T = typename iterator_traits<Iterator>::value_type::value_type;
+
+    vector<FractionAccumulator<T>> partials = mapChunks(first, last, pool, [](Iterator chunkFirst, Iterator chunkLast) {
+        FractionAccumulator<T> partial(Fraction<T>(1));
+        for (; chunkFirst != chunkLast; ++chunkFirst) {
+            partial *= *chunkFirst;
+        }
+        return partial;
+    });
+
+    return combineTree(partials, [](FractionAccumulator<T> left, const FractionAccumulator<T> &right) {
+        return left *= right;
+    }).result();
+}
+
+// folds [first, last) with an associative combine(Fraction, Fraction) starting from identity,
+// each chunk is folded in order and the chunk results are combined in a tree
+template <typename Iterator, typename Combine>
+auto parallelReduce(Iterator first, Iterator last, typename iterator_traits<Iterator>::value_type identity, Combine combine,
+                    ThreadPool &pool = ThreadPool::shared()) {
+    using Value = typename iterator_traits<Iterator>::value_type;
+
+    vector<Value> partials = mapChunks(first, last, pool, [identity, combine](Iterator chunkFirst, Iterator chunkLast) {
+        Value partial = identity;
+        for (; chunkFirst != chunkLast; ++chunkFirst) {
+            partial = combine(partial, *chunkFirst);
+        }
+        return partial;
+    });
+
+    return combineTree(partials, combine);
+}
@@ -0,0 +1,217 @@
+/*
+File: fractionSort.h
+Author: Logan Copeland
+Description: Fast exact sorting of large arrays of fractions
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <future>
+#include <cstdint>
+
+#include "fractionCalculator.h"
+#include "threadPool.h"
+
+using namespace std;
+
+// 32.32 fixed-point floor of a fraction, clamped to the int64_t range. The key never
+// decreases as the fraction increases, so sorting by key and then comparing exactly
+// within runs of equal keys gives the exact order.
+template <typename T>
+constexpr int64_t sortKey(const Fraction<T> &fraction) {
+    using U = make_unsigned_t<T>;
+
+    // floor division into a whole part and a remainder 0 <= rest < denom
+    T whole = fraction.numerator() / fraction.denominator();
+    T rest = fraction.numerator() % fraction.denominator();
+    if (rest < 0) {
+        whole -= 1;
+        rest += fraction.denominator();
+    }
+
+    // only types wider than 32 bits can hold a whole part outside the key range, narrower ones
+    // would truncate the bounds themselves
+    if constexpr (sizeof(T) > sizeof(int32_t)) {
+        if (whole < T(INT32_MIN)) {
+            return INT64_MIN;
+        }
+        if (whole > T(INT32_MAX)) {
+            return INT64_MAX;
+        }
+    }
+
+    // floor(rest * 2^32 / denom)
+    uint64_t fractionBits = 0;
+    if constexpr (sizeof(T) <= sizeof(int32_t)) {
+        fractionBits = (uint64_t(U(rest)) << 32) / U(fraction.denominator());
+    } else if constexpr (sizeof(T) <= sizeof(int64_t)) {
+        fractionBits = uint64_t(((unsigned __int128)U(rest) << 32) / U(fraction.denominator()));
+    } else {
+        U remainder = U(rest);
+        U denom = U(fraction.denominator());
+        for (int bit = 0; bit < 32; bit++) {
+            // remainder < denom < 2^127, so doubling cannot overflow
+            remainder <<= 1;
+            fractionBits <<= 1;
+            if (remainder >= denom) {
+                remainder -= denom;
+                fractionBits |= 1;
+            }
+        }
+    }
+
+    return int64_t(whole) * (int64_t(1) << 32) + int64_t(fractionBits);
+}
+
+struct FractionSortEntry {
+    uint64_t key; // sortKey with the sign bit flipped so unsigned order matches signed order
+    size_t index; // position in the input
+};
+
+// sorts entries by key with an LSD radix sort on bytes, skipping bytes that are the same everywhere
+inline void radixSortEntries(vector<FractionSortEntry> &entries) {
+    // histogram every byte position in a single pass over the keys
+    vector<array<size_t, 256>> counts(8);
+    for (const FractionSortEntry &entry : entries) {
+        for (int digit = 0; digit < 8; digit++) {
+            counts[digit][(entry.key >> (8 * digit)) & 0xFF]++;
+        }
+    }
+
+    vector<FractionSortEntry> buffer(entries.size());
+    for (int digit = 0; digit < 8; digit++) {
+        int shift = 8 * digit;
+        array<size_t, 256> &offsets = counts[digit];
+        if (offsets[(entries[0].key >> shift) & 0xFF] == entries.size()) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t &count : offsets) {
+            size_t next = offset + count;
+            count = offset;
+            offset = next;
+        }
+        for (const FractionSortEntry &entry : entries) {
+            buffer[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries.swap(buffer);
+    }
+}
+
+// sorts entries by key and resolves runs of equal keys with the exact comparison
+template <typename T>
+void sortEntries(vector<FractionSortEntry> &entries, const vector<Fraction<T>> &fractions) {
+    auto exactLess = [&fractions](const FractionSortEntry &left, const FractionSortEntry &right) {
+        return fractions[left.index] < fractions[right.index];
+    };
+
+    // radix passes only pay off once there are enough entries to amortize the count tables
+    if (entries.size() < 1024) {
+        sort(entries.begin(), entries.end(), [&exactLess](const FractionSortEntry &left, const FractionSortEntry &right) {
+            return (left.key != right.key) ? (left.key < right.key) : exactLess(left, right);
+        });
+        return;
+    }
+
+    radixSortEntries(entries);
+    for (size_t first = 0; first < entries.size();) {
+        size_t last = first + 1;
+        while (last < entries.size() && entries[last].key == entries[first].key) {
+            last++;
+        }
+        if (last - first > 1) {
+            sort(entries.begin() + first, entries.begin() + last, exactLess);
+        }
+        first = last;
+    }
+}
+
+// builds the key array for fractions[first, last)
+template <typename T>
+void buildSortEntries(const vector<Fraction<T>> &fractions, vector<FractionSortEntry> &entries, size_t first, size_t last) {
+    for (size_t i = first; i < last; i++) {
+        entries[i].key = uint64_t(sortKey(fractions[i])) ^ (uint64_t(1) << 63);
+        entries[i].index = i;
+    }
+}
+
+// reorders fractions to follow the sorted entries
+template <typename T>
+void applySortEntries(vector<Fraction<T>> &fractions, const vector<FractionSortEntry> &entries) {
+    vector<Fraction<T>> sorted;
+    sorted.reserve(fractions.size());
+    for (const FractionSortEntry &entry : entries) {
+        sorted.push_back(fractions[entry.index]);
+    }
+    fractions.swap(sorted);
+}
+
+// sorts fractions into ascending exact order
+template <typename T>
+void sortFractions(vector<Fraction<T>> &fractions) {
+    if (fractions.size() < 2) {
+        return;
+    }
+
+    vector<FractionSortEntry> entries(fractions.size());
+    buildSortEntries(fractions, entries, 0, fractions.size());
+    sortEntries(entries, fractions);
+    applySortEntries(fractions, entries);
+}
+
+// sorts fractions into ascending exact order, sorting equal slices on pool workers and merging them pairwise
+template <typename T>
+void parallelSortFractions(vector<Fraction<T>> &fractions, ThreadPool &pool = ThreadPool::shared()) {
+    size_t size = fractions.size();
+    size_t minSliceSize = 1 << 16; // smaller slices are not worth a task
+    unsigned numThreads = max(1u, min(pool.size(), unsigned(size / minSliceSize)));
+    if (numThreads == 1) {
+        sortFractions(fractions);
+        return;
+    }
+
+    vector<FractionSortEntry> entries(size);
+    vector<size_t> bounds(numThreads + 1);
+    for (unsigned i = 0; i <= numThreads; i++) {
+        bounds[i] = size * i / numThreads;
+    }
+
+    // key and sort each slice independently
+    vector<future<void>> workers;
+    for (unsigned i = 0; i < numThreads; i++) {
+        workers.push_back(pool.submit([&, i]() {
+            buildSortEntries(fractions, entries, bounds[i], bounds[i + 1]);
+            vector<FractionSortEntry> slice(entries.begin() + bounds[i], entries.begin() + bounds[i + 1]);
+            sortEntries(slice, fractions);
+            copy(slice.begin(), slice.end(), entries.begin() + bounds[i]);
+        }));
+    }
+    for (future<void> &worker : workers) {
+        worker.get();
+    }
+
+    // merge neighbouring slices in rounds, each round's merges run concurrently
+    auto entryLess = [&fractions](const FractionSortEntry &left, const FractionSortEntry &right) {
+        return (left.key != right.key) ? (left.key < right.key) : (fractions[left.index] < fractions[right.index]);
+    };
+    for (size_t width = 1; width < numThreads; width *= 2) {
+        workers.clear();
+        for (size_t i = 0; i + width < numThreads; i += 2 * width) {
+            size_t first = bounds[i];
+            size_t middle = bounds[i + width];
+            size_t last = bounds[min(i + 2 * width, size_t(numThreads))];
+            workers.push_back(pool.submit([&entries, &entryLess, first, middle, last]() {
+                inplace_merge(entries.begin() + first, entries.begin() + middle, entries.begin() + last, entryLess);
+            }));
+        }
+        for (future<void> &worker : workers) {
+            worker.get();
+        }
+    }
+
+    applySortEntries(fractions, entries);
+}
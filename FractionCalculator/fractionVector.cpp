@@ -0,0 +1,309 @@
+/*
+File: fractionVector.cpp
+Author: Logan Copeland
+Description: Structure-of-arrays fraction container implementation file
+*/
+
+#include "fractionVector.h"
+
+#include <vector>
+#include <algorithm>
+#include <immintrin.h>
+
+using namespace std;
+
+// kernels work through the arrays in blocks so their scratch arrays stay in L1
+static const size_t blockSize = 512;
+
+static bool hasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+// writes a fraction given in lowest terms, throws if it does not fit in 32 bits like Fraction does
+static inline void storeFraction(uint64_t numMagnitude, uint64_t denomMagnitude, bool negative, int32_t &num, int32_t &denom) {
+    if (numMagnitude == 0) {
+        num = 0;
+        denom = 1;
+        return;
+    }
+    if ((denomMagnitude > uint64_t(INT32_MAX)) || (numMagnitude > (negative ? uint64_t(INT32_MAX) + 1 : uint64_t(INT32_MAX)))) {
+        throw FractionException("Overflow!");
+    }
+    num = negative ? int32_t(uint32_t(0) - uint32_t(numMagnitude)) : int32_t(numMagnitude);
+    denom = int32_t(denomMagnitude);
+}
+
+// GCD kernels:
+
+// per-lane count of trailing zero bits, the exponent of the lowest set bit converted to float
+// (zero lanes give a negative count, which variable shifts treat as shifting everything out)
+__attribute__((target("avx2")))
+static inline __m256i trailingZeros8(__m256i x) {
+    __m256i lowest = _mm256_and_si256(x, _mm256_sub_epi32(_mm256_setzero_si256(), x));
+    __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(lowest)), 23);
+    return _mm256_sub_epi32(_mm256_and_si256(exponent, _mm256_set1_epi32(0xFF)), _mm256_set1_epi32(127));
+}
+
+// Stein's algorithm on eight lanes at once, lanes that finish early are masked off until all are done
+__attribute__((target("avx2")))
+static size_t batchGcdAvx2(const uint32_t *x, const uint32_t *y, uint32_t *result, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i inputX = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+        __m256i inputY = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i));
+        __m256i eitherZero = _mm256_or_si256(_mm256_cmpeq_epi32(inputX, zero), _mm256_cmpeq_epi32(inputY, zero));
+
+        __m256i shift = trailingZeros8(_mm256_or_si256(inputX, inputY));
+        __m256i a = _mm256_srlv_epi32(inputX, trailingZeros8(inputX));
+        __m256i b = _mm256_andnot_si256(eitherZero, inputY);
+
+        while (!_mm256_testz_si256(b, b)) {
+            __m256i done = _mm256_cmpeq_epi32(b, zero);
+            b = _mm256_srlv_epi32(b, trailingZeros8(b));
+            __m256i smaller = _mm256_min_epu32(a, b);
+            __m256i larger = _mm256_max_epu32(a, b);
+            a = _mm256_blendv_epi8(smaller, a, done);
+            b = _mm256_andnot_si256(done, _mm256_sub_epi32(larger, smaller));
+        }
+
+        // gcd(0, y) is y and gcd(x, 0) is x
+        __m256i gcd = _mm256_blendv_epi8(_mm256_sllv_epi32(a, shift), _mm256_or_si256(inputX, inputY), eitherZero);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), gcd);
+    }
+    return i;
+}
+
+void batchGcd(const uint32_t *x, const uint32_t *y, uint32_t *result, size_t count) {
+    size_t i = hasAvx2() ? batchGcdAvx2(x, y, result, count) : 0;
+    for (; i < count; i++) {
+        result[i] = binaryGcd(x[i], y[i]);
+    }
+}
+
+// compare kernels:
+
+// sign of left.num * right.denom - right.num * left.denom on eight lanes, even and odd lanes
+// are widened to 64 bits separately
+__attribute__((target("avx2")))
+static size_t compareAvx2(const int32_t *leftNum, const int32_t *leftDenom, const int32_t *rightNum, const int32_t *rightDenom,
+                          int32_t *result, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i *>(leftNum + i));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i *>(leftDenom + i));
+        __m256i c = _mm256_load_si256(reinterpret_cast<const __m256i *>(rightNum + i));
+        __m256i d = _mm256_load_si256(reinterpret_cast<const __m256i *>(rightDenom + i));
+
+        __m256i leftEven = _mm256_mul_epi32(a, d);
+        __m256i rightEven = _mm256_mul_epi32(c, b);
+        __m256i leftOdd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(d, 32));
+        __m256i rightOdd = _mm256_mul_epi32(_mm256_srli_epi64(c, 32), _mm256_srli_epi64(b, 32));
+
+        // all-ones masks, so less minus greater is -1, 0 or 1
+        __m256i even = _mm256_sub_epi64(_mm256_cmpgt_epi64(rightEven, leftEven), _mm256_cmpgt_epi64(leftEven, rightEven));
+        __m256i odd = _mm256_sub_epi64(_mm256_cmpgt_epi64(rightOdd, leftOdd), _mm256_cmpgt_epi64(leftOdd, rightOdd));
+        __m256i order = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), order);
+    }
+    return i;
+}
+
+// FractionVector:
+
+FractionVector::FractionVector() {}
+
+FractionVector::FractionVector(size_t size) : num(size, 0), denom(size, 1) {}
+
+FractionVector::FractionVector(const vector<Fraction<int32_t>> &fractions) {
+    reserve(fractions.size());
+    for (const Fraction<int32_t> &fraction : fractions) {
+        push_back(fraction);
+    }
+}
+
+size_t FractionVector::size() const {
+    return num.size();
+}
+
+void FractionVector::resize(size_t size) {
+    num.resize(size, 0);
+    denom.resize(size, 1);
+}
+
+void FractionVector::reserve(size_t capacity) {
+    num.reserve(capacity);
+    denom.reserve(capacity);
+}
+
+void FractionVector::push_back(const Fraction<int32_t> &fraction) {
+    num.push_back(fraction.numerator());
+    denom.push_back(fraction.denominator());
+}
+
+void FractionVector::push_back(int32_t num, int32_t denom) {
+    this->num.push_back(num);
+    this->denom.push_back(denom);
+}
+
+Fraction<int32_t> FractionVector::operator[](size_t index) const {
+    return Fraction<int32_t>(num[index], denom[index]);
+}
+
+void FractionVector::set(size_t index, const Fraction<int32_t> &fraction) {
+    num[index] = fraction.numerator();
+    denom[index] = fraction.denominator();
+}
+
+vector<Fraction<int32_t>> FractionVector::toFractions() const {
+    vector<Fraction<int32_t>> fractions;
+    fractions.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+        fractions.push_back((*this)[i]);
+    }
+    return fractions;
+}
+
+int32_t *FractionVector::numerators() {
+    return num.data();
+}
+
+const int32_t *FractionVector::numerators() const {
+    return num.data();
+}
+
+int32_t *FractionVector::denominators() {
+    return denom.data();
+}
+
+const int32_t *FractionVector::denominators() const {
+    return denom.data();
+}
+
+void FractionVector::checkSizes(const FractionVector &left, const FractionVector &right, FractionVector &result) {
+    if (left.size() != right.size()) {
+        throw FractionException("Size mismatch!");
+    }
+    result.resize(left.size());
+}
+
+void FractionVector::add(const FractionVector &left, const FractionVector &right, FractionVector &result) {
+    checkSizes(left, right, result);
+
+    alignas(32) uint32_t factor[blockSize], remainder[blockSize], factor2[blockSize];
+    alignas(32) int64_t sum[blockSize];
+
+    for (size_t first = 0; first < left.size(); first += blockSize) {
+        size_t count = min(blockSize, left.size() - first);
+        const int32_t *a = left.num.data() + first, *b = left.denom.data() + first;
+        const int32_t *c = right.num.data() + first, *d = right.denom.data() + first;
+
+        // the same steps as Fraction::add: divide out gcd(b, d), cross-multiply in 64 bits,
+        // then divide out gcd(sum, factor), which is only non-trivial when factor is not 1
+        batchGcd(reinterpret_cast<const uint32_t *>(b), reinterpret_cast<const uint32_t *>(d), factor, count);
+        for (size_t i = 0; i < count; i++) {
+            int64_t leftScale = (factor[i] == 1) ? d[i] : int64_t(uint32_t(d[i]) / factor[i]);
+            int64_t rightScale = (factor[i] == 1) ? b[i] : int64_t(uint32_t(b[i]) / factor[i]);
+            sum[i] = a[i] * leftScale + c[i] * rightScale;
+            remainder[i] = (factor[i] == 1) ? 0 : uint32_t(magnitude(sum[i]) % factor[i]);
+        }
+        batchGcd(remainder, factor, factor2, count);
+
+        for (size_t i = 0; i < count; i++) {
+            uint64_t numMagnitude = magnitude(sum[i]);
+            uint64_t denomMagnitude = uint64_t(uint32_t(b[i]) / factor[i]) * uint32_t(d[i]);
+            if (factor2[i] != 1) {
+                numMagnitude /= factor2[i];
+                denomMagnitude = uint64_t(uint32_t(b[i]) / factor[i]) * (uint32_t(d[i]) / factor2[i]);
+            }
+            storeFraction(numMagnitude, denomMagnitude, sum[i] < 0, result.num[first + i], result.denom[first + i]);
+        }
+    }
+}
+
+void FractionVector::multiply(const int32_t *leftNum, const int32_t *leftDenom, const int32_t *rightNum, const int32_t *rightDenom,
+                              int32_t *resultNum, int32_t *resultDenom, size_t count) {
+    alignas(32) uint32_t a[blockSize], b[blockSize], c[blockSize], d[blockSize];
+    alignas(32) uint32_t leftFactor[blockSize], rightFactor[blockSize];
+
+    for (size_t first = 0; first < count; first += blockSize) {
+        size_t blockCount = min(blockSize, count - first);
+        for (size_t i = 0; i < blockCount; i++) {
+            a[i] = magnitude(leftNum[first + i]);
+            b[i] = magnitude(leftDenom[first + i]);
+            c[i] = magnitude(rightNum[first + i]);
+            d[i] = magnitude(rightDenom[first + i]);
+        }
+
+        // cross-cancel like Fraction::multiply, the products are then already in lowest terms
+        batchGcd(a, d, leftFactor, blockCount);
+        batchGcd(c, b, rightFactor, blockCount);
+
+        for (size_t i = 0; i < blockCount; i++) {
+            size_t j = first + i;
+            bool negative = (leftNum[j] < 0) ^ (leftDenom[j] < 0) ^ (rightNum[j] < 0) ^ (rightDenom[j] < 0);
+            uint64_t numMagnitude = uint64_t(a[i] / leftFactor[i]) * (c[i] / rightFactor[i]);
+            uint64_t denomMagnitude = uint64_t(b[i] / rightFactor[i]) * (d[i] / leftFactor[i]);
+            storeFraction(numMagnitude, denomMagnitude, negative, resultNum[j], resultDenom[j]);
+        }
+    }
+}
+
+void FractionVector::mul(const FractionVector &left, const FractionVector &right, FractionVector &result) {
+    checkSizes(left, right, result);
+    multiply(left.num.data(), left.denom.data(), right.num.data(), right.denom.data(), result.num.data(), result.denom.data(), left.size());
+}
+
+void FractionVector::div(const FractionVector &left, const FractionVector &right, FractionVector &result) {
+    checkSizes(left, right, result);
+
+    // throw exception if any quotient is undefined
+    if (find(right.num.begin(), right.num.end(), 0) != right.num.end()) {
+        throw FractionException("Undefined!");
+    }
+
+    // multiply by the inverse, multiply() takes care of the sign of its denominators
+    multiply(left.num.data(), left.denom.data(), right.denom.data(), right.num.data(), result.num.data(), result.denom.data(), left.size());
+}
+
+void FractionVector::compare(const FractionVector &left, const FractionVector &right, vector<int32_t> &result) {
+    if (left.size() != right.size()) {
+        throw FractionException("Size mismatch!");
+    }
+    result.resize(left.size());
+
+    size_t i = 0;
+    if (hasAvx2()) {
+        i = compareAvx2(left.num.data(), left.denom.data(), right.num.data(), right.denom.data(), result.data(), left.size());
+    }
+    for (; i < left.size(); i++) {
+        int64_t leftCross = int64_t(left.num[i]) * right.denom[i];
+        int64_t rightCross = int64_t(right.num[i]) * left.denom[i];
+        result[i] = (leftCross > rightCross) - (leftCross < rightCross);
+    }
+}
+
+void FractionVector::reduce(FractionVector &fractions, size_t first) {
+    alignas(32) uint32_t numMagnitude[blockSize], denomMagnitude[blockSize], factor[blockSize];
+
+    for (; first < fractions.size(); first += blockSize) {
+        size_t count = min(blockSize, fractions.size() - first);
+        int32_t *num = fractions.num.data() + first;
+        int32_t *denom = fractions.denom.data() + first;
+
+        for (size_t i = 0; i < count; i++) {
+            // throw exception if fraction is undefined
+            if (denom[i] == 0) {
+                throw FractionException("Undefined!");
+            }
+            numMagnitude[i] = magnitude(num[i]);
+            denomMagnitude[i] = magnitude(denom[i]);
+        }
+
+        batchGcd(numMagnitude, denomMagnitude, factor, count);
+        for (size_t i = 0; i < count; i++) {
+            storeFraction(numMagnitude[i] / factor[i], denomMagnitude[i] / factor[i], (num[i] < 0) != (denom[i] < 0), num[i], denom[i]);
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+File: fractionVector.h
+Author: Logan Copeland
+Description: Structure-of-arrays fraction container with batch arithmetic kernels
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <new>
+
+#include "fractionCalculator.h"
+
+using namespace std;
+
+// allocator that aligns storage to a SIMD register boundary
+template <typename T, size_t Alignment = 32>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t count) {
+        return static_cast<T *>(::operator new(count * sizeof(T), align_val_t(Alignment)));
+    }
+
+    void deallocate(T *block, size_t) {
+        ::operator delete(block, align_val_t(Alignment));
+    }
+
+    friend bool operator==(const AlignedAllocator &, const AlignedAllocator &) {
+        return true;
+    }
+};
+
+// Stores Fraction<int32_t> values as separate aligned arrays of numerators and denominators
+// so that batch kernels can work on many fractions at once. Every kernel produces exactly the
+// value the scalar Fraction operator would, and throws the same FractionException when it would.
+class FractionVector {
+public:
+    using Array = vector<int32_t, AlignedAllocator<int32_t>>;
+
+    FractionVector(); // default constructor
+    FractionVector(size_t size); // constructor, size fractions equal to zero
+    FractionVector(const vector<Fraction<int32_t>> &fractions); // constructor
+
+    size_t size() const;
+    void resize(size_t size);
+    void reserve(size_t capacity);
+    void push_back(const Fraction<int32_t> &fraction);
+    void push_back(int32_t num, int32_t denom); // appends a raw value, normalize it with reduce() before use
+    Fraction<int32_t> operator[](size_t index) const; // element getter
+    void set(size_t index, const Fraction<int32_t> &fraction); // element setter
+    vector<Fraction<int32_t>> toFractions() const;
+
+    // raw arrays, values written through these must be normalized with reduce() before other kernels use them
+    int32_t *numerators();
+    const int32_t *numerators() const;
+    int32_t *denominators();
+    const int32_t *denominators() const;
+
+    // batch kernels, operands must have the same size and the result may alias either operand. Only the
+    // GCD steps and compare are vectorized, the rest of add, mul, div and reduce is scalar.
+    static void add(const FractionVector &left, const FractionVector &right, FractionVector &result);
+    static void mul(const FractionVector &left, const FractionVector &right, FractionVector &result);
+    static void div(const FractionVector &left, const FractionVector &right, FractionVector &result);
+    static void compare(const FractionVector &left, const FractionVector &right, vector<int32_t> &result); // -1, 0 or 1 per element
+    static void reduce(FractionVector &fractions, size_t first = 0); // normalizes every element from first onwards in place
+
+private:
+    Array num; // numerators
+    Array denom; // denominators
+
+    static void checkSizes(const FractionVector &left, const FractionVector &right, FractionVector &result);
+    static void multiply(const int32_t *leftNum, const int32_t *leftDenom, const int32_t *rightNum, const int32_t *rightDenom,
+                         int32_t *resultNum, int32_t *resultDenom, size_t count);
+};
+
+// greatest common divisors of count pairs, gcd(0, y) is y, uses AVX2 when the CPU supports it
+void batchGcd(const uint32_t *x, const uint32_t *y, uint32_t *result, size_t count);
@@ -5,13 +5,151 @@ Description: Test file for fractionCalculator.cpp
 */
 
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
 using namespace std;
 
 #include "fractionCalculator.h"
+#include "fractionAccumulator.h"
+#include "fractionExpression.h"
+#include "fractionParser.h"
 
-int main() {
+// collects output into one large block so that each write system call covers many results
+class OutputBuffer {
+public:
+	OutputBuffer(FILE *file) : file(file), buffer(1 << 20), used(0) {}
+	~OutputBuffer() { flush(); }
+
+	void write(string_view text) {
+		if (used + text.length() > buffer.size()) {
+			flush();
+		}
+		if (text.length() > buffer.size()) {
+			fwrite(text.data(), 1, text.length(), file);
+			return;
+		}
+		memcpy(buffer.data() + used, text.data(), text.length());
+		used += text.length();
+	}
+
+	// formats "x/y" directly into the block instead of going through two ostream inserts
+	void writeFraction(const Fraction<> &fraction) {
+		char digits[2 * numeric_limits<int>::digits10 + 8];
+		char *end = digits + sizeof(digits);
+		char *start = formatInteger(end, fraction.denominator());
+		*--start = '/';
+		start = formatInteger(start, fraction.numerator());
+		write(string_view(start, end - start));
+	}
+
+	void flush() {
+		fwrite(buffer.data(), 1, used, file);
+		used = 0;
+	}
+
+private:
+	FILE *file;
+	vector<char> buffer;
+	size_t used;
+};
+
+// writes the value of one input line: a fraction, an integer or an expression without variables
+void evaluateLine(string_view line, OutputBuffer &out) {
+	while (!line.empty() && isspace((unsigned char)line.back())) {
+		line.remove_suffix(1);
+	}
+	while (!line.empty() && isspace((unsigned char)line.front())) {
+		line.remove_prefix(1);
+	}
+
+	// plain "x/y" and integer lines skip the expression compiler and never throw
+	expected<Fraction<>, FractionError> value = parseFraction<int>(line);
+	if (value) {
+		out.writeFraction(*value);
+	} else if (line.empty()) {
+		// keep blank lines so output lines still match input lines
+	} else if (value.error() != FractionError::InvalidInput) {
+		out.write(errorMessage(value.error()));
+	} else {
+		// a line that is not a constant expression is reported as invalid input, like interactive mode does
+		try {
+			FractionExpression<> expression(line);
+			if (expression.variables().empty()) {
+				out.writeFraction(expression.evaluate(vector<Fraction<>>()));
+			} else {
+				out.write(errorMessage(FractionError::InvalidInput));
+			}
+		} catch (FractionException &e) {
+			out.write((e.what() == "Invalid expression!") ? string(errorMessage(FractionError::InvalidInput)) : e.what());
+		}
+	}
+	out.write("\n");
+}
+
+// evaluates every complete line of text and returns the unfinished tail
+string_view evaluateLines(string_view text, OutputBuffer &out) {
+	size_t end;
+	while ((end = text.find('\n')) != string_view::npos) {
+		evaluateLine(text.substr(0, end), out);
+		text.remove_prefix(end + 1);
+	}
+	return text;
+}
+
+// batch mode: one result per input line, no prompts and no per-line flushes
+int runBatch(const char *path) {
+	OutputBuffer out(stdout);
+	if (path != nullptr) {
+		try {
+			MappedFile file(path);
+			string_view rest = evaluateLines(file.contents(), out);
+			if (!rest.empty()) {
+				evaluateLine(rest, out);
+			}
+		} catch (FractionException &e) {
+			out.flush();
+			cerr << e.what() << endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	// read stdin in large blocks, carrying a partial last line over to the next block
+	vector<char> block(1 << 20);
+	string carry;
+	size_t length;
+	while ((length = fread(block.data(), 1, block.size(), stdin)) > 0) {
+		string_view text(block.data(), length);
+		if (!carry.empty()) {
+			size_t end = text.find('\n');
+			if (end == string_view::npos) {
+				carry.append(text);
+				continue;
+			}
+			carry.append(text.substr(0, end));
+			evaluateLine(carry, out);
+			carry.clear();
+			text.remove_prefix(end + 1);
+		}
+		carry.assign(evaluateLines(text, out));
+	}
+	if (!carry.empty()) {
+		evaluateLine(carry, out);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+	// "--batch [file]" evaluates a file or stdin line by line instead of prompting
+	if ((argc > 1) && (string_view(argv[1]) == "--batch")) {
+		return runBatch((argc > 2) ? argv[2] : nullptr);
+	}
 	
-	Fraction sum(0);
+	FractionAccumulator<> sum; // only reduced when the sum is read or nears overflow
 	Fraction fin;
 	cout << "\nSumming fractions..." << endl;
 	cout << "Enter fractions as \"x/y\" or a single integer." << endl;
@@ -25,7 +163,11 @@ int main() {
 			cout << e.what() << endl;
 		}
 	} while (fin != 0);
-	cout << "Sum is: " << sum << "\n" << endl;
+	try {
+		cout << "Sum is: " << sum.result() << "\n" << endl;
+	} catch (FractionException &e) {
+		cout << e.what() << endl;
+	}
 
 	return 0;
 
@@ -0,0 +1,62 @@
+/*
+File: threadPool.cpp
+Author: Logan Copeland
+Description: Fixed-size worker thread pool implementation file
+*/
+
+#include "threadPool.h"
+
+#include <thread>
+#include <mutex>
+
+using namespace std;
+
+ThreadPool::ThreadPool(unsigned numThreads) : stopping(false) {
+    // hardware_concurrency() may report 0 when it cannot tell
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+
+    for (unsigned i = 0; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(queueLock);
+        stopping = true;
+    }
+    taskReady.notify_all();
+
+    for (thread &worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::size() const {
+    return unsigned(workers.size());
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> guard(queueLock);
+            taskReady.wait(guard, [this]() {
+                return stopping || !tasks.empty();
+            });
+            if (tasks.empty()) {
+                return; // stopping and nothing left to run
+            }
+            task = move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
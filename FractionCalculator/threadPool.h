@@ -0,0 +1,60 @@
+/*
+File: threadPool.h
+Author: Logan Copeland
+Description: Fixed-size worker thread pool header file
+*/
+
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+using namespace std;
+
+// Runs submitted tasks on a fixed set of worker threads. Tasks must not block waiting on
+// other tasks of the same pool.
+class ThreadPool {
+public:
+    ThreadPool(unsigned numThreads = thread::hardware_concurrency()); // constructor
+    ~ThreadPool(); // destructor, finishes queued tasks and joins the workers
+    ThreadPool(const ThreadPool &other) = delete;
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+
+    unsigned size() const; // number of worker threads
+
+    template <typename Function>
+    future<invoke_result_t<Function>> submit(Function task); // queues task, the future holds its result or exception
+
+    static ThreadPool &shared(); // process-wide pool with one worker per hardware thread
+
+private:
+    vector<thread> workers; // worker threads
+    queue<function<void()>> tasks; // pending tasks
+    mutex queueLock; // guards tasks and stopping
+    condition_variable taskReady; // signalled when a task is queued or the pool stops
+    bool stopping; // set by the destructor
+
+    void workerLoop();
+};
+
+template <typename Function>
+future<invoke_result_t<Function>> ThreadPool::submit(Function task) {
+    // packaged_task is move-only, share it so the queue can hold a copyable function
+    auto packaged = make_shared<packaged_task<invoke_result_t<Function>()>>(move(task));
+    future<invoke_result_t<Function>> result = packaged->get_future();
+    {
+        lock_guard<mutex> guard(queueLock);
+        tasks.push([packaged]() {
+            (*packaged)();
+        });
+    }
+    taskReady.notify_one();
+    return result;
+}
@@ -0,0 +1,156 @@
+/*
+File: benchmarkInsultGenerator.cpp
+Author: Logan Copeland
+Description: Benchmarks for the Insult Generator, prints one CSV row per operation and request size
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+
+#include "insultGenerator.h"
+
+using namespace std;
+
+// every allocation in the process goes through these, so a benchmark can count its own. Worker
+// threads allocate too, so the count is atomic.
+static atomic<size_t> numAllocations(0);
+
+void *operator new(size_t size) {
+    numAllocations.fetch_add(1, memory_order_relaxed);
+    void *memory = malloc(size ? size : 1);
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept {
+    free(memory);
+}
+
+// Runs work warmup times untimed, then repetitions times timed by the wall clock, and prints the
+// spread of the samples. insults is how many insults one run produces, 0 if it produces none.
+static void benchmark(const string &name, uint64_t insults, int warmup, int repetitions, const function<void()> &work) {
+    for (int i = 0; i < warmup; i++) {
+        work();
+    }
+
+    vector<double> samples; // microseconds per run
+    samples.reserve(repetitions);
+    size_t allocationsBefore = numAllocations.load(memory_order_relaxed);
+    for (int i = 0; i < repetitions; i++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        work();
+        samples.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+    }
+    double allocations = double(numAllocations.load(memory_order_relaxed) - allocationsBefore) / repetitions;
+
+    sort(samples.begin(), samples.end());
+    auto percentile = [&](double fraction) {
+        return samples[min(samples.size() - 1, size_t(fraction * samples.size()))];
+    };
+    cout << name << "," << insults << "," << repetitions << "," << samples.front() << "," << percentile(0.5) << ","
+         << percentile(0.9) << "," << percentile(0.99) << ",";
+    if (insults > 0) {
+        cout << 1e3 * percentile(0.5) / insults << "," << allocations / insults;
+    } else {
+        cout << ",";
+    }
+    cout << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    // optional arguments: number of timed repetitions and vocabulary file
+    int repetitions = (argc > 1) ? atoi(argv[1]) : 20;
+    string fileName = (argc > 2) ? argv[2] : "InsultsSource.txt";
+    if (repetitions < 1) {
+        cerr << "usage: " << argv[0] << " [repetitions >= 1] [vocabularyFile]" << endl;
+        return 1;
+    }
+    const int warmup = 2;
+    const string savedFile = "benchmarkInsults.txt";
+
+    try {
+        cout << "benchmark,insults,samples,min_us,p50_us,p90_us,p99_us,ns_per_insult,allocations_per_insult\n";
+
+        benchmark("initialize", 0, warmup, repetitions, [&]() {
+            InsultGenerator generator(1);
+            generator.initialize(fileName);
+        });
+
+        // a fixed seed so that every run and every version draws the same insults
+        InsultGenerator generator(2024);
+        generator.initialize(fileName);
+
+        const int talkBatch = 10000;
+        benchmark("talkToMe", talkBatch, warmup, repetitions, [&]() {
+            for (int i = 0; i < talkBatch; i++) {
+                string insult = generator.talkToMe();
+                asm volatile("" : : "r"(insult.data()) : "memory");
+            }
+        });
+
+        // request sizes from 1 up to every combination, by powers of 10
+        vector<uint64_t> sizes;
+        uint64_t total = generator.combinationCount();
+        for (uint64_t size = 1; size < total && size <= uint64_t(INT32_MAX); size *= 10) {
+            sizes.push_back(size);
+        }
+        if (total <= uint64_t(INT32_MAX)) {
+            sizes.push_back(total);
+        }
+
+        InsultBuffer insults;
+        for (uint64_t size : sizes) {
+            int numInsults = int(size);
+            benchmark("generate", size, warmup, repetitions, [&]() {
+                vector<string> insultList = generator.generate(numInsults);
+                asm volatile("" : : "r"(insultList.data()) : "memory");
+            });
+            benchmark("generate_buffer", size, warmup, repetitions, [&]() {
+                generator.generate(numInsults, insults);
+            });
+            benchmark("generateParallel_buffer", size, warmup, repetitions, [&]() {
+                generator.generateParallel(numInsults, insults);
+            });
+            benchmark("generateAndSave", size, warmup, repetitions, [&]() {
+                generator.generateAndSave(savedFile, numInsults);
+            });
+        }
+        remove(savedFile.c_str());
+    } catch (FileException &e) {
+        cerr << e.what() << endl;
+        return 1;
+    } catch (NumInsultsOutOfBounds &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    cout << flush;
+
+    return 0;
+}
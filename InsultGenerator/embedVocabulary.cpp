@@ -0,0 +1,114 @@
+/*
+File: embedVocabulary.cpp
+Author: Logan Copeland
+Description: Build tool that turns a vocabulary file into constexpr tables for embeddedVocabulary.h
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+using namespace std;
+
+// word as a C++ string literal
+static string quote(const string &word) {
+    string literal = "\"";
+    for (unsigned char character : word) {
+        if (character == '"' || character == '\\') {
+            literal += '\\';
+            literal += char(character);
+        } else if (character < 0x20 || character >= 0x7F) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\%03o", character);
+            literal += escaped;
+        } else {
+            literal += char(character);
+        }
+    }
+    return literal + "\"";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        cerr << "Usage: " << argv[0] << " vocabularyFile > embeddedVocabulary.h" << endl;
+        return 1;
+    }
+
+    ifstream file(argv[1], ios::binary);
+    if (file.fail()) {
+        cerr << "Unable to read " << argv[1] << "!" << endl;
+        return 1;
+    }
+
+    // the same rules as InsultGenerator::initialize(fileName): cell i of a line goes to column i,
+    // cells are trimmed of spaces and carriage returns, and blank cells are skipped
+    vector<vector<string>> columns;
+    string line;
+    while (getline(file, line)) {
+        istringstream cells(line);
+        string cell;
+        for (size_t column = 0; getline(cells, cell, '\t'); column++) {
+            size_t first = cell.find_first_not_of(" \r");
+            if (first == string::npos) {
+                continue;
+            }
+            if (column >= columns.size()) {
+                columns.resize(column + 1);
+            }
+            columns[column].push_back(cell.substr(first, cell.find_last_not_of(" \r") + 1 - first));
+        }
+    }
+
+    // sorted like the generator sorts them, a word listed twice in a column is one word
+    for (vector<string> &words : columns) {
+        sort(words.begin(), words.end());
+        words.erase(unique(words.begin(), words.end()), words.end());
+    }
+
+    // place values are checked here, a constexpr product would silently wrap
+    vector<uint64_t> placeValues(columns.size());
+    uint64_t total = 1;
+    for (size_t i = columns.size(); i-- > 0; ) {
+        if (columns[i].empty() || __builtin_mul_overflow(total, uint64_t(columns[i].size()), &total)) {
+            columns.clear();
+            break;
+        }
+        placeValues[i] = total / columns[i].size();
+    }
+    if (columns.empty()) {
+        cerr << "Invalid vocabulary in " << argv[1] << "!" << endl;
+        return 1;
+    }
+
+    size_t maxLength = columns.size() + 5; // "Thou ", the separating spaces and "!"
+    for (const vector<string> &words : columns) {
+        size_t longest = 0;
+        for (const string &word : words) {
+            longest = max(longest, word.length());
+        }
+        maxLength += longest;
+    }
+
+    cout << "/*\nFile: embeddedVocabulary.h\nAuthor: generated by embedVocabulary.cpp from " << argv[1]
+         << "\nDescription: Vocabulary compiled into the Insult Generator, do not edit\n*/\n\n"
+         << "#pragma once\n\n#include <string_view>\n\n#include \"insultGenerator.h\"\n\nusing namespace std;\n";
+    for (size_t i = 0; i < columns.size(); i++) {
+        cout << "\nconstexpr string_view embeddedColumn" << i << "[] = {\n";
+        for (const string &word : columns[i]) {
+            cout << "    " << quote(word) << ",\n";
+        }
+        cout << "};\n";
+    }
+    cout << "\nconstexpr VocabularyColumn embeddedColumns[] = {\n";
+    for (size_t i = 0; i < columns.size(); i++) {
+        cout << "    {embeddedColumn" << i << ", " << columns[i].size() << ", " << placeValues[i] << "ULL, nullptr, nullptr},\n";
+    }
+    cout << "};\n\nconstexpr size_t embeddedMaxLength = " << maxLength << ";\n";
+
+    return 0;
+}
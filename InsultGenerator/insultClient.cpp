@@ -0,0 +1,161 @@
+/*
+File: insultClient.cpp
+Author: Logan Copeland
+Description: Load generator for the Insult Generator daemon, prints latency percentiles and throughput
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+// Sends numRequests copies of request over its own connection, keeping depth of them in flight, and
+// records the time from sending each request to receiving the last line of its answer.
+static bool runConnection(const string &socketPath, const string &request, size_t numRequests, size_t depth, vector<double> &latencies, string &error) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    int descriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (descriptor < 0 || connect(descriptor, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        error = "Unable to connect to " + socketPath + "!";
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+        return false;
+    }
+
+    deque<Clock::time_point> sent; // send times of the requests in flight, oldest first
+    size_t numSent = 0;
+    string batch;
+    string input;
+    size_t parsed = 0; // bytes of input already consumed
+    size_t linesLeft = 0; // insult lines still due for the oldest request, after its "OK k" line
+    bool inAnswer = false;
+    vector<char> block(1 << 16);
+    latencies.reserve(latencies.size() + numRequests);
+
+    while (latencies.size() < numRequests) {
+        // top the pipeline up, all new requests go out in one write
+        batch.clear();
+        Clock::time_point now = Clock::now();
+        while (numSent < numRequests && sent.size() < depth) {
+            batch.append(request);
+            sent.push_back(now);
+            numSent++;
+        }
+        for (size_t written = 0; written < batch.size(); ) {
+            ssize_t result = write(descriptor, batch.data() + written, batch.size() - written);
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result <= 0) {
+                error = "Connection lost!";
+                close(descriptor);
+                return false;
+            }
+            written += result;
+        }
+
+        ssize_t received = read(descriptor, block.data(), block.size());
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            error = "Connection lost!";
+            close(descriptor);
+            return false;
+        }
+        input.append(block.data(), received);
+
+        // walk the complete lines, an answer ends with the last of its k insults
+        Clock::time_point arrived = Clock::now();
+        for (size_t end = input.find('\n', parsed); end != string::npos; end = input.find('\n', parsed)) {
+            if (!inAnswer) {
+                if (input.compare(parsed, 3, "OK ") != 0) {
+                    error = "Server answered " + input.substr(parsed, end - parsed);
+                    close(descriptor);
+                    return false;
+                }
+                linesLeft = strtoull(input.c_str() + parsed + 3, nullptr, 10);
+                inAnswer = true;
+            } else {
+                linesLeft--;
+            }
+            parsed = end + 1;
+            if (inAnswer && linesLeft == 0) {
+                latencies.push_back(chrono::duration<double, micro>(arrived - sent.front()).count());
+                sent.pop_front();
+                inAnswer = false;
+            }
+        }
+        input.erase(0, parsed);
+        parsed = 0;
+    }
+
+    close(descriptor);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    // optional arguments: socket path, connections, requests per connection, requests in flight per
+    // connection, and insults per request (0 for talk requests)
+    string socketPath = (argc > 1) ? argv[1] : "insultGenerator.sock";
+    size_t numConnections = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 4;
+    size_t numRequests = (argc > 3) ? strtoull(argv[3], nullptr, 10) : 100000;
+    size_t depth = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 16;
+    int numInsults = (argc > 5) ? atoi(argv[5]) : 0;
+    if (numConnections < 1 || numRequests < 1 || depth < 1 || numInsults < 0) {
+        cerr << "usage: " << argv[0] << " [socket] [connections >= 1] [requests >= 1] [depth >= 1] [insults per request, 0 for talk]" << endl;
+        return 1;
+    }
+    string request = (numInsults == 0) ? "talk\n" : "generate " + to_string(numInsults) + "\n";
+
+    vector<vector<double>> latencies(numConnections);
+    vector<string> errors(numConnections);
+    vector<thread> clients;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < numConnections; i++) {
+        clients.emplace_back([&, i]() {
+            runConnection(socketPath, request, numRequests, depth, latencies[i], errors[i]);
+        });
+    }
+    for (thread &client : clients) {
+        client.join();
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    for (const string &error : errors) {
+        if (!error.empty()) {
+            cerr << error << endl;
+            return 1;
+        }
+    }
+
+    vector<double> all;
+    for (const vector<double> &connectionLatencies : latencies) {
+        all.insert(all.end(), connectionLatencies.begin(), connectionLatencies.end());
+    }
+    sort(all.begin(), all.end());
+    auto percentile = [&](double fraction) {
+        return all[min(all.size() - 1, size_t(fraction * all.size()))];
+    };
+
+    cout << "request,connections,depth,requests,seconds,requests_per_s,p50_us,p99_us,p999_us\n";
+    cout << ((numInsults == 0) ? string("talk") : "generate " + to_string(numInsults)) << "," << numConnections << "," << depth << ","
+         << all.size() << "," << seconds << "," << all.size() / seconds << ","
+         << percentile(0.5) << "," << percentile(0.99) << "," << percentile(0.999) << endl;
+
+    return 0;
+}
@@ -7,110 +7,1161 @@ Description: Implementation file for a Shakespearian Insult Generator
 #include <iostream>
 #include <vector>
 #include <fstream>
-#include <sstream>
+#include <cstring>
 #include <string>
 #include <random>
-#include <chrono>
-#include <set>
+#include <algorithm>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <charconv>
+#include <cmath>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "insultGenerator.h"
+#include "issuedBitmap.h"
+#ifdef EMBEDDED_VOCABULARY
+#include "embeddedVocabulary.h"
+#endif
 
 using namespace std;
 
-// default null constructor
-InsultGenerator::InsultGenerator() {}
+// splitmix64 finalizer, a cheap bijective mix of all 64 bits
+static inline uint64_t mix64(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// runs task(0) ... task(numTasks - 1) on up to numThreads threads, each thread taking the next task when it finishes one
+static void runTasks(size_t numTasks, unsigned numThreads, const function<void(size_t)> &task) {
+    numThreads = unsigned(min(size_t(numThreads), numTasks));
+    if (numThreads <= 1) {
+        for (size_t i = 0; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    atomic<size_t> next(0);
+    vector<thread> workers;
+    for (unsigned i = 0; i < numThreads; i++) {
+        workers.emplace_back([&]() {
+            for (size_t taskIndex = next++; taskIndex < numTasks; taskIndex = next++) {
+                task(taskIndex);
+            }
+        });
+    }
+    for (thread &worker : workers) {
+        worker.join();
+    }
+}
+
+// a vocabulary read from a file, the words view the mapping and the columns view the words
+struct LoadedVocabulary {
+    LoadedVocabulary(const string &fileName) : file(fileName) {}
+
+    MappedFile file;
+    vector<vector<string_view>> words;
+    vector<vector<double>> weights; // weights of the words, empty for an unweighted vocabulary
+    vector<vector<AliasEntry>> aliases; // alias tables built from the weights
+    vector<VocabularyColumn> columns;
+};
+
+// Sorts words alphabetically, moving their weights along with them if there are any, and merges
+// repeats of a word into one, adding up their weights. Each word is paired with its first 8 bytes
+// packed big-endian, so most comparisons are one integer compare and only ties on the prefix read
+// the words themselves.
+static void sortWords(vector<string_view> &words, vector<double> *weights) {
+    struct KeyedWord {
+        uint64_t prefix;
+        string_view word;
+        double weight;
+    };
+    vector<KeyedWord> keyed(words.size());
+    for (size_t i = 0; i < words.size(); i++) {
+        uint64_t prefix = 0;
+        for (size_t j = 0; j < 8; j++) {
+            prefix = (prefix << 8) | ((j < words[i].length()) ? uint8_t(words[i][j]) : 0);
+        }
+        keyed[i] = {prefix, words[i], (weights != nullptr) ? (*weights)[i] : 0};
+    }
+    sort(keyed.begin(), keyed.end(), [](const KeyedWord &a, const KeyedWord &b) {
+        return (a.prefix != b.prefix) ? (a.prefix < b.prefix) : (a.word < b.word);
+    });
+    size_t count = 0;
+    for (size_t i = 0; i < keyed.size(); i++) {
+        if (count > 0 && keyed[i].word == words[count - 1]) {
+            if (weights != nullptr) {
+                (*weights)[count - 1] += keyed[i].weight;
+            }
+            continue;
+        }
+        words[count] = keyed[i].word;
+        if (weights != nullptr) {
+            (*weights)[count] = keyed[i].weight;
+        }
+        count++;
+    }
+    words.resize(count);
+    if (weights != nullptr) {
+        weights->resize(count);
+    }
+}
+
+// reads a finite, non-negative weight
+static bool parseWeight(string_view cell, double &weight) {
+    const char *end = cell.data() + cell.size();
+    from_chars_result result = from_chars(cell.data(), end, weight);
+    return (result.ec == errc()) && (result.ptr == end) && isfinite(weight) && (weight >= 0);
+}
+
+// Vose's alias method: slot i keeps word i with probability threshold / 2^64 and otherwise gives its
+// alias, so a uniform slot plus one comparison draws a word in proportion to its weight
+static vector<AliasEntry> buildAliasTable(const vector<double> &weights) {
+    size_t size = weights.size();
+    double total = 0;
+    for (double weight : weights) {
+        total += weight;
+    }
+
+    // scaled[i] is the share of word i in units of one slot, under 1 means the slot has room for an alias
+    vector<double> scaled(size);
+    vector<size_t> small, large;
+    for (size_t i = 0; i < size; i++) {
+        scaled[i] = weights[i] * size / total;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+
+    vector<AliasEntry> table(size);
+    while (!small.empty() && !large.empty()) {
+        size_t under = small.back();
+        size_t over = large.back();
+        small.pop_back();
+        table[under] = {uint64_t(ldexp(scaled[under], 64)), over};
+
+        // the large word gives away the rest of the small word's slot
+        scaled[over] -= 1 - scaled[under];
+        if (scaled[over] < 1) {
+            large.pop_back();
+            small.push_back(over);
+        }
+    }
+
+    // what is left is 1 up to rounding error, these slots always keep their own word
+    for (size_t i : small) {
+        table[i] = {UINT64_MAX, i};
+    }
+    for (size_t i : large) {
+        table[i] = {UINT64_MAX, i};
+    }
+    return table;
+}
+
+// default constructor, a different sequence on every run
+InsultGenerator::InsultGenerator() : columns(nullptr), numColumns(0), maxLength(0) {
+    random_device device;
+    engine.seed((uint64_t(device()) << 32) | device());
+}
+
+InsultGenerator::InsultGenerator(uint64_t seed) : columns(nullptr), numColumns(0), maxLength(0), engine(seed) {}
+
+void InsultGenerator::seed(uint64_t seed) {
+    engine.seed(seed);
+}
 
 void InsultGenerator::initialize() {
-    string line;
-    string word1, word2, word3;
-    ifstream file;
-    istringstream ss;
+#ifdef EMBEDDED_VOCABULARY
+    // the vocabulary compiled into the binary, nothing to read, allocate or check
+    vocabulary.reset();
+    issued.reset();
+    columns = embeddedColumns;
+    numColumns = size(embeddedColumns);
+    maxLength = embeddedMaxLength;
+#else
+    initialize("InsultsSource.txt");
+#endif
+}
 
-    file.open("InsultsSource.txt");
+void InsultGenerator::initialize(const string &fileName, bool weighted) {
+    // map the file and parse it in place, the words are views into the mapping
+    shared_ptr<LoadedVocabulary> loaded = make_shared<LoadedVocabulary>(fileName);
+    string_view text = loaded->file.contents();
+    vector<vector<string_view>> &words = loaded->words;
+    vector<vector<double>> &weights = loaded->weights;
 
-    // throw exception if file cannot be opened
-    if (file.fail()) {
-		throw FileException("Unable to read file!");
-	}
-    
-    // read each line from the file and store each word in the associated column vector
-    while (!file.eof()) {
-        getline(file, line);
-        ss.str(line);
-        ss >> word1;
-        ss >> word2;
-        ss >> word3;
-        column1.push_back(word1);
-        column2.push_back(word2);
-        column3.push_back(word3);
-        ss.clear();
+    // one pass over the lines, cell i of a line goes to column i and blank cells are skipped, so
+    // columns can have different lengths. A missing newline at the end is the same as one. In a
+    // weighted vocabulary cells come in word, weight pairs instead, pair i going to column i.
+    size_t cellsPerWord = weighted ? 2 : 1;
+    const char *position = text.data();
+    const char *end = text.data() + text.size();
+    while (position < end) {
+        const char *lineEnd = static_cast<const char *>(memchr(position, '\n', end - position));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        bool hasWord = false; // the last word cell was not blank
+        for (size_t cellIndex = 0; ; cellIndex++) {
+            const char *cellEnd = static_cast<const char *>(memchr(position, '\t', lineEnd - position));
+            if (cellEnd == nullptr) {
+                cellEnd = lineEnd;
+            }
+            string_view cell(position, cellEnd - position);
+            size_t first = cell.find_first_not_of(" \r");
+            if (first != string_view::npos) {
+                cell = cell.substr(first, cell.find_last_not_of(" \r") + 1 - first);
+            } else {
+                cell = string_view();
+            }
+
+            size_t column = cellIndex / cellsPerWord;
+            if (cellIndex % cellsPerWord == 0) {
+                hasWord = !cell.empty();
+                if (hasWord) {
+                    if (column >= words.size()) {
+                        words.resize(column + 1);
+                        weights.resize(weighted ? column + 1 : 0);
+                    }
+                    words[column].push_back(cell);
+                }
+            } else {
+                // a weight must go with a word, and a weight of zero drops the word
+                double weight = 0;
+                if (hasWord != !cell.empty() || (hasWord && !parseWeight(cell, weight))) {
+                    throw FileException("Invalid weight in " + fileName + "!");
+                }
+                if (hasWord && weight == 0) {
+                    words[column].pop_back();
+                } else if (hasWord) {
+                    weights[column].push_back(weight);
+                }
+                hasWord = false;
+            }
+            position = cellEnd + 1;
+            if (cellEnd == lineEnd) {
+                break;
+            }
+        }
+        if (weighted && hasWord) {
+            throw FileException("Invalid weight in " + fileName + "!");
+        }
+    }
+
+    // with each column in alphabetical order, combination indices sort the same way as the insults
+    // (the separating space sorts before every character used in a word). Merging repeated words
+    // keeps distinct indices distinct insults.
+    loaded->aliases.resize(weights.size());
+    runTasks(words.size(), max(1u, thread::hardware_concurrency()), [&](size_t column) {
+        sortWords(words[column], weighted ? &weights[column] : nullptr);
+        if (weighted && !words[column].empty()) {
+            loaded->aliases[column] = buildAliasTable(weights[column]);
+        }
+    });
+
+    // every column needs a word, and every combination must have a 64-bit index
+    if (words.empty()) {
+        throw FileException("Invalid vocabulary in " + fileName + "!");
     }
+    loaded->columns.resize(words.size());
+    uint64_t total = 1;
+    for (size_t i = words.size(); i-- > 0; ) {
+        if (words[i].empty() || __builtin_mul_overflow(total, uint64_t(words[i].size()), &total)) {
+            throw FileException("Invalid vocabulary in " + fileName + "!");
+        }
+        loaded->columns[i] = {words[i].data(), words[i].size(), total / words[i].size(), nullptr, nullptr};
+        if (weighted) {
+            loaded->columns[i].weights = weights[i].data();
+            loaded->columns[i].aliases = loaded->aliases[i].data();
+        }
+    }
+
+    vocabulary = loaded;
+    issued.reset(); // a bitmap only fits the vocabulary it was made for
+    columns = loaded->columns.data();
+    numColumns = loaded->columns.size();
+    maxLength = maxInsultLength();
+}
 
-    file.close();
+int InsultGenerator::randInt(int bound) {
+    // draw from the persistent engine, no clock read or engine setup per call
+    return int(engine.bounded(uint64_t(bound)));
 }
 
-int InsultGenerator::randInt() {
-    // generate a seed using steady_clock
-    unsigned long long int seed = chrono::steady_clock::now().time_since_epoch().count();
-    // use the seed to generate a random number
-    default_random_engine engine(seed);
-    // map the random number to a uniform distribution between 0 and 49 inclusive
-    uniform_int_distribution<int> distribution(0,49);
+uint64_t InsultGenerator::drawWord(const VocabularyColumn &column) {
+    // pick a slot uniformly, then keep its word or take its alias
+    uint64_t word = engine.bounded(column.size);
+    if (column.aliases != nullptr && engine() >= column.aliases[word].threshold) {
+        word = column.aliases[word].alias;
+    }
+    return word;
+}
 
-    return distribution(engine);
+uint64_t InsultGenerator::drawIndex() {
+    uint64_t index = 0;
+    for (size_t i = 0; i < numColumns; i++) {
+        index += drawWord(columns[i]) * columns[i].placeValue;
+    }
+    return index;
 }
 
 string InsultGenerator::talkToMe() {
-    string insult = "Thou " + column1[randInt()] + " " + column2[randInt()] + " " + column3[randInt()] + "!";
+    if (issued != nullptr) {
+        return insultAt(issueIndex());
+    }
+
+    // assemble in one allocation instead of through temporaries
+    string insult;
+    insult.reserve(maxLength);
+    insult.append("Thou ");
+    for (size_t i = 0; i < numColumns; i++) {
+        insult.append((i == 0) ? "" : " ").append(columns[i].words[drawWord(columns[i])]);
+    }
+    insult.append("!");
 
     return insult;
 }
 
-vector<string> InsultGenerator::generate(int numInsults) {
-    set<string> insultListSet;
+uint64_t InsultGenerator::combinationCount() const {
+    if (numColumns == 0) {
+        return 0;
+    }
+    return columns[0].placeValue * columns[0].size;
+}
+
+char *InsultGenerator::writeInsult(char *out, uint64_t index) const {
+    // index is a mixed-radix number with one digit per column, the last column least significant
+    memcpy(out, "Thou ", 5);
+    out += 5;
+    for (size_t i = 0; i < numColumns; i++) {
+        string_view word = columns[i].words[(index / columns[i].placeValue) % columns[i].size];
+        if (i > 0) {
+            *out++ = ' ';
+        }
+        memcpy(out, word.data(), word.length());
+        out += word.length();
+    }
+    *out++ = '!';
+    return out;
+}
+
+size_t InsultGenerator::insultLength(uint64_t index) const {
+    size_t length = numColumns + 5; // "Thou ", the separating spaces and "!"
+    for (size_t i = 0; i < numColumns; i++) {
+        length += columns[i].words[(index / columns[i].placeValue) % columns[i].size].length();
+    }
+    return length;
+}
+
+size_t InsultGenerator::maxInsultLength() const {
+    size_t length = numColumns + 5; // "Thou ", the separating spaces and "!"
+    for (size_t i = 0; i < numColumns; i++) {
+        size_t longest = 0;
+        for (size_t j = 0; j < columns[i].size; j++) {
+            longest = max(longest, columns[i].words[j].length());
+        }
+        length += longest;
+    }
+    return length;
+}
+
+string InsultGenerator::insultAt(uint64_t index) const {
+    char buffer[256];
+    if (maxLength <= sizeof(buffer)) {
+        return string(buffer, writeInsult(buffer, index));
+    }
+    string insult(maxLength, ' ');
+    insult.resize(writeInsult(insult.data(), index) - insult.data());
+    return insult;
+}
+
+vector<uint64_t> InsultGenerator::sampleIndices(uint64_t count, uint64_t total) {
+    if (issued != nullptr) {
+        return sampleUnissuedIndices(count);
+    }
+    if (columns[0].aliases != nullptr) {
+        return sampleWeightedIndices(count);
+    }
+
+    vector<uint64_t> indices;
+    indices.reserve(count);
+
+    if (total / 64 <= count) {
+        // dense request, Floyd's algorithm over a bitset: for each j in [total - count, total) pick
+        // t in [0, j] and take t, or j itself if t was already taken
+        vector<uint64_t> taken((total + 63) / 64);
+        for (uint64_t j = total - count; j < total; j++) {
+            uint64_t t = engine.bounded(j + 1);
+            uint64_t pick = (taken[t / 64] >> (t % 64) & 1) ? j : t;
+            taken[pick / 64] |= uint64_t(1) << (pick % 64);
+        }
+        for (uint64_t word = 0; word < taken.size(); word++) {
+            for (uint64_t bits = taken[word]; bits != 0; bits &= bits - 1) {
+                indices.push_back(word * 64 + __builtin_ctzll(bits));
+            }
+        }
+        return indices;
+    }
+
+    // sparse request, draw the missing number of indices, sort them in and drop repeats until
+    // enough are distinct. Nothing in this favours any index, so every subset is equally likely,
+    // and repeats are rare enough that it seldom takes more than one round.
+    while (indices.size() < count) {
+        size_t numSorted = indices.size();
+        while (indices.size() < count) {
+            indices.push_back(engine.bounded(total));
+        }
+        sort(indices.begin() + numSorted, indices.end());
+        inplace_merge(indices.begin(), indices.begin() + numSorted, indices.end());
+        indices.erase(unique(indices.begin(), indices.end()), indices.end());
+    }
+    return indices;
+}
+
+vector<uint64_t> InsultGenerator::sampleWeightedIndices(uint64_t count) {
+    // Weighted sampling without replacement: each new insult is drawn in proportion to the product of
+    // its word weights among the insults not drawn yet.
+    uint64_t total = combinationCount();
+    vector<uint64_t> indices;
+    indices.reserve(count);
+
+    // the smallest drawKey() keys of all combinations come in the same order as these draws would,
+    // the log weights are only loaded when keys are needed
+    vector<vector<double>> weights;
+
+    // a key for every combination costs 16 bytes each, only worth it for small spaces
+    const uint64_t maxDenseKeys = uint64_t(1) << 24;
+    if (total / 4 <= count && total <= maxDenseKeys) {
+        // dense request, keep the count smallest of all the keys
+        weights = logWeights();
+        vector<pair<double, uint64_t>> keys(total);
+        for (uint64_t index = 0; index < total; index++) {
+            keys[index] = {drawKey(index, weights), index};
+        }
+        nth_element(keys.begin(), keys.begin() + (count - 1), keys.end());
+        for (uint64_t i = 0; i < count; i++) {
+            indices.push_back(keys[i].second);
+        }
+        sort(indices.begin(), indices.end());
+        return indices;
+    }
+
+    // sparse request, draw the missing number of insults word by word from the alias tables, sort
+    // them in and drop repeats. The distinct insults of a run of draws are the ones drawing again
+    // after each repeat would give. The rounds get about as many draws as one pass over every key
+    // would cost, past that it is faster to stop retrying, or hopeless if the space is too large
+    // for such a pass.
+    const uint64_t maxStreamedKeys = uint64_t(1) << 30;
+    uint64_t maxDraws = 4 * count + min(total, maxStreamedKeys) / 4;
+    uint64_t numDraws = 0;
+    while (indices.size() < count) {
+        if (numDraws >= maxDraws) {
+            // most draws now repeat, the insults left hold little of the weight. What is still missing
+            // is a weighted sample of the insults not drawn yet, so finish with their smallest keys,
+            // keeping only as many as are missing.
+            if (total > maxStreamedKeys) {
+                throw NumInsultsOutOfBounds("Too many insults for this weighted vocabulary!");
+            }
+            weights = logWeights();
+            uint64_t missing = count - indices.size();
+            priority_queue<pair<double, uint64_t>> smallest; // largest kept key on top
+            size_t drawn = 0; // indices is sorted, walked alongside to skip the insults already drawn
+            for (uint64_t index = 0; index < total; index++) {
+                if (drawn < indices.size() && indices[drawn] == index) {
+                    drawn++;
+                    continue;
+                }
+                double key = drawKey(index, weights);
+                if (smallest.size() < missing) {
+                    smallest.push({key, index});
+                } else if (key < smallest.top().first) {
+                    smallest.pop();
+                    smallest.push({key, index});
+                }
+            }
+            for (; !smallest.empty(); smallest.pop()) {
+                indices.push_back(smallest.top().second);
+            }
+            sort(indices.begin(), indices.end());
+            break;
+        }
+
+        size_t numSorted = indices.size();
+        numDraws += count - numSorted;
+        while (indices.size() < count) {
+            indices.push_back(drawIndex());
+        }
+        sort(indices.begin() + numSorted, indices.end());
+        inplace_merge(indices.begin(), indices.begin() + numSorted, indices.end());
+        indices.erase(unique(indices.begin(), indices.end()), indices.end());
+    }
+    return indices;
+}
+
+vector<vector<double>> InsultGenerator::logWeights() const {
+    vector<vector<double>> weights(numColumns);
+    for (size_t i = 0; i < numColumns; i++) {
+        for (size_t j = 0; j < columns[i].size; j++) {
+            weights[i].push_back(log(columns[i].weights[j]));
+        }
+    }
+    return weights;
+}
+
+double InsultGenerator::drawKey(uint64_t index, const vector<vector<double>> &logWeights) {
+    // Efraimidis and Spirakis: log(E) - log(weight) for an exponential E, so that taking the smallest
+    // keys is the same as drawing by weight without replacement
+    double key = log(-log(engine.uniform()) + 0x1p-60); // the offset keeps a uniform of 1 finite
+    for (size_t i = 0; i < numColumns; i++) {
+        key -= logWeights[i][(index / columns[i].placeValue) % columns[i].size];
+    }
+    return key;
+}
+
+void InsultGenerator::trackIssued(const string &fileName) {
+    // one bit per insult, past 2^36 bits the file alone would take 8 GiB of disk and address space
+    const uint64_t maxTrackedInsults = uint64_t(1) << 36;
+    if (combinationCount() > maxTrackedInsults) {
+		throw FileException("Too many insults to track in " + fileName + "!");
+	}
+    issued = make_shared<IssuedBitmap>(fileName, combinationCount(), vocabularyFingerprint());
+}
+
+void InsultGenerator::stopTrackingIssued() {
+    issued.reset();
+}
+
+uint64_t InsultGenerator::unissuedCount() const {
+    return (issued != nullptr) ? issued->unissuedCount() : combinationCount();
+}
+
+uint64_t InsultGenerator::vocabularyFingerprint() const {
+    // FNV-1a over every word in index order, with a separator after each word and each column
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    auto add = [&](unsigned char byte) {
+        hash = (hash ^ byte) * 0x100000001B3ULL;
+    };
+    for (size_t i = 0; i < numColumns; i++) {
+        for (size_t j = 0; j < columns[i].size; j++) {
+            for (char character : columns[i].words[j]) {
+                add(character);
+            }
+            add('\n');
+        }
+        add('\t');
+    }
+    return mix64(hash);
+}
+
+uint64_t InsultGenerator::issueIndex() {
+    uint64_t index;
+    return tryIssueIndex(index) ? index : issueWeighted(1)[0];
+}
+
+bool InsultGenerator::tryIssueIndex(uint64_t &index) {
+    if (columns[0].aliases == nullptr) {
+        index = issued->issueRandom(engine);
+        return true;
+    }
+
+    // weighted draws skip insults already issued, at one bit test each, as long as the insults left
+    // hold enough of the weight to turn up within a few draws
+    for (int attempt = 0; attempt < 64; attempt++) {
+        if (issued->unissuedCount() == 0) {
+            throw NumInsultsOutOfBounds("Every insult has been issued!");
+        }
+        index = drawIndex();
+        if (issued->issue(index)) {
+            return true;
+        }
+    }
+    return false;
+}
 
+vector<uint64_t> InsultGenerator::issueWeighted(uint64_t count) {
+    vector<uint64_t> indices;
+    indices.reserve(count);
+
+    // too many insults left to give each a key, the bitmap's count-guided walk still finds free ones
+    // at once, though equally likely rather than by weight
+    const uint64_t maxWeighedInsults = uint64_t(1) << 24;
+    if (issued->unissuedCount() > maxWeighedInsults) {
+        while (indices.size() < count) {
+            indices.push_back(issued->issueRandom(engine));
+        }
+        return indices;
+    }
+
+    // Draws by weight are memoryless, so the next count draws are the insults not issued yet with the
+    // smallest drawKey() keys. The walk visits each of them once and skips full blocks.
+    vector<vector<double>> weights = logWeights();
+    priority_queue<pair<double, uint64_t>> smallest; // largest kept key on top
+    uint64_t total = combinationCount();
+    for (uint64_t index = issued->nextUnissued(0); index < total; ) {
+        double key = drawKey(index, weights);
+        if (smallest.size() < count) {
+            smallest.push({key, index});
+        } else if (key < smallest.top().first) {
+            smallest.pop();
+            smallest.push({key, index});
+        }
+
+        uint64_t next = (index + 1 < total) ? issued->nextUnissued(index + 1) : total;
+        index = (next > index) ? next : total; // stop where the walk wraps around
+    }
+
+    // another process may issue some of them first, those are drawn again
+    for (; !smallest.empty(); smallest.pop()) {
+        indices.push_back(issued->issue(smallest.top().second) ? smallest.top().second : issueIndex());
+    }
+    while (indices.size() < count) {
+        indices.push_back(issueIndex());
+    }
+    return indices;
+}
+
+vector<uint64_t> InsultGenerator::sampleUnissuedIndices(uint64_t count) {
+    if (count > issued->unissuedCount()) {
+		throw NumInsultsOutOfBounds("Not enough unissued insults!");
+	}
+
+    // every insult taken is marked issued at once, which also keeps the insults of this call distinct
+    vector<uint64_t> indices;
+    indices.reserve(count);
+    while (indices.size() < count) {
+        uint64_t index;
+        if (!tryIssueIndex(index)) {
+            // the weighted draws keep finding issued insults, take the rest in one pass over the free ones
+            vector<uint64_t> rest = issueWeighted(count - indices.size());
+            indices.insert(indices.end(), rest.begin(), rest.end());
+            break;
+        }
+        indices.push_back(index);
+    }
+    sort(indices.begin(), indices.end());
+    return indices;
+}
+
+vector<string> InsultGenerator::generate(int numInsults) {
     // check that numInsults falls within the acceptable range
-    if (numInsults < 1 || numInsults > 10000) {
+    if (numInsults < 1 || uint64_t(numInsults) > combinationCount()) {
 		throw NumInsultsOutOfBounds("Invalid number of insults!");
 	}
 
-    // generate insults and store them in the set insultListSet
-    int i = 0;
-    while (i < numInsults) {
-        string insult = talkToMe();
-        
-        // check if the generated insult already belongs to the set
-        if (insultListSet.find(insult) == insultListSet.end()) {
-            insultListSet.insert(insult); // sets store strings alphabetically
-            i++; // only increment i when an insult is added to the set
-        }
+    // choose distinct combinations as integers and only build strings for the chosen ones,
+    // ascending indices give the insults in alphabetical order
+    vector<string> insultList;
+    insultList.reserve(numInsults);
+    for (uint64_t index : sampleIndices(numInsults, combinationCount())) {
+        insultList.push_back(insultAt(index));
+    }
+
+    return insultList;
+}
+
+void InsultGenerator::generate(int numInsults, InsultBuffer &insults) {
+    if (numInsults < 1 || uint64_t(numInsults) > combinationCount()) {
+		throw NumInsultsOutOfBounds("Invalid number of insults!");
+	}
+
+    // size the buffer once for the longest possible insults, then trim it to what was written
+    insults.clear();
+    insults.characters.resize(size_t(numInsults) * (maxLength + 1));
+    insults.offsets.reserve(size_t(numInsults) + 1);
+    char *start = insults.characters.data();
+    char *out = start;
+    for (uint64_t index : sampleIndices(numInsults, combinationCount())) {
+        out = writeInsult(out, index);
+        *out++ = '\n';
+        insults.offsets.push_back(out - start);
     }
+    insults.characters.resize(out - start);
+}
 
-    // copy the set to a vector
-    vector<string> insultListVector(insultListSet.begin(), insultListSet.end());
+template <typename Emit>
+void InsultGenerator::sampleIndicesInOrder(uint64_t count, uint64_t total, Emit emit) {
+    // Vitter's sequential sampling (Algorithm D, finishing with Algorithm A once the sample is a large
+    // part of what remains): each step draws how many indices to skip before the next chosen one,
+    // so the indices come out ascending in O(count) time and constant memory
+    uint64_t current = 0; // index after the last chosen one
+    uint64_t n = count;
+    uint64_t remaining = total; // indices from current on
+    auto choose = [&](uint64_t skip) {
+        current += skip;
+        emit(current++);
+        remaining -= skip + 1;
+        n--;
+    };
+
+    const double alphaInverse = 13; // Algorithm D is used while remaining > 13 * n
+    double nInverse = 1.0 / n;
+    double vPrime = exp(log(engine.uniform()) * nInverse);
+    uint64_t qu1 = remaining - n + 1;
+    while (n > 1 && alphaInverse * n < remaining) {
+        double nReal = n;
+        double remainingReal = remaining;
+        double nMinus1Inverse = 1.0 / (nReal - 1);
+        uint64_t skip;
+        while (true) {
+            // D2: a candidate skip from the continuous approximation
+            double x;
+            while (true) {
+                x = remainingReal * (1 - vPrime);
+                skip = uint64_t(x);
+                if (skip < qu1) {
+                    break;
+                }
+                vPrime = exp(log(engine.uniform()) * nInverse);
+            }
+
+            // D3: accept through the cheap bound most of the time
+            double u = engine.uniform();
+            double y1 = exp(log(u * remainingReal / qu1) * nMinus1Inverse);
+            vPrime = y1 * (1 - x / remainingReal) * (qu1 / (double(qu1) - skip));
+            if (vPrime <= 1) {
+                break;
+            }
+
+            // D4: otherwise compare against the exact probability
+            double y2 = 1;
+            double top = remainingReal - 1;
+            double bottom;
+            uint64_t limit;
+            if (n - 1 > skip) {
+                bottom = remainingReal - nReal;
+                limit = remaining - skip;
+            } else {
+                bottom = remainingReal - skip - 1;
+                limit = qu1;
+            }
+            for (uint64_t t = remaining - 1; t >= limit; t--) {
+                y2 = (y2 * top) / bottom;
+                top--;
+                bottom--;
+            }
+            if (remainingReal / (remainingReal - x) >= y1 * exp(log(y2) * nMinus1Inverse)) {
+                vPrime = exp(log(engine.uniform()) * nMinus1Inverse);
+                break;
+            }
+            vPrime = exp(log(engine.uniform()) * nInverse);
+        }
+        choose(skip);
+        qu1 -= skip;
+        nInverse = nMinus1Inverse;
+    }
 
-    return insultListVector;
+    // Algorithm A: walk the skip distribution one index at a time
+    double top = double(remaining - n);
+    double remainingReal = remaining;
+    while (n > 1) {
+        double v = engine.uniform();
+        uint64_t skip = 0;
+        double quotient = top / remainingReal;
+        while (quotient > v && skip < remaining - n) {
+            skip++;
+            top--;
+            remainingReal--;
+            quotient *= top / remainingReal;
+        }
+        choose(skip);
+        remainingReal--;
+    }
+    if (n == 1) {
+        choose(engine.bounded(remaining));
+    }
 }
 
 void InsultGenerator::generateAndSave(string fileName,int numInsults) {
-    vector<string> insultList = generate(numInsults); // generate insults
-    ofstream file;
+    if (numInsults < 1 || uint64_t(numInsults) > combinationCount()) {
+		throw NumInsultsOutOfBounds("Invalid number of insults!");
+	}
+
+    // weighted or tracked draws need the whole sample, and can throw, so take it before touching
+    // the file. Plain uniform draws are streamed in order while writing.
+    bool streamed = columns[0].aliases == nullptr && issued == nullptr;
+    vector<uint64_t> indices;
+    if (!streamed) {
+        indices = sampleIndices(numInsults, combinationCount());
+    }
 
-    // open or create file fileName
-    file.open(fileName);
+    // write to a temporary file next to fileName and rename it into place once complete, so a
+    // failed call leaves any previous fileName as it was. Each call gets its own uniquely named
+    // temporary file, so concurrent saves to the same name never write into each other's, and it
+    // takes the permissions of the file it replaces. Devices and pipes are written directly.
+    // The guard closes the file, and removes the temporary one, on every way out before the rename.
+    struct OutputFile {
+        string temporaryName; // empty when writing to fileName directly
+        int descriptor;
+        ~OutputFile() {
+            if (descriptor >= 0) {
+                close(descriptor);
+            }
+            if (!temporaryName.empty()) {
+                unlink(temporaryName.c_str());
+            }
+        }
+    };
+    struct stat status;
+    bool exists = stat(fileName.c_str(), &status) == 0;
+    bool replaced = !exists || S_ISREG(status.st_mode);
+    OutputFile output = {"", -1};
+    if (replaced) {
+        string temporaryName = fileName + ".XXXXXX";
+        output.descriptor = mkostemp(temporaryName.data(), O_CLOEXEC);
+        if (output.descriptor >= 0) {
+            output.temporaryName = temporaryName;
+        }
+    } else {
+        output.descriptor = open(fileName.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    }
 
     // throw exception if file cannot be written
-    if (file.fail()) {
+    if (output.descriptor < 0) {
+		throw FileException("Unable to write to " + fileName + "!");
+	}
+
+    // mkostemp creates the file readable by its owner only
+    if (replaced && fchmod(output.descriptor, exists ? (status.st_mode & 07777) : 0644) != 0) {
+		throw FileException("Unable to write to " + fileName + "!");
+	}
+
+    // insults are written into a fixed buffer that goes to the file whenever it is nearly full, so
+    // memory does not grow with numInsults and nothing is flushed per line
+    vector<char> buffer(max(size_t(1) << 20, 2 * (maxLength + 1)));
+    char *out = buffer.data();
+    auto flush = [&]() {
+        for (const char *start = buffer.data(); start < out; ) {
+            ssize_t written = write(output.descriptor, start, out - start);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                throw FileException("Unable to write to " + fileName + "!");
+            }
+            start += written;
+        }
+        out = buffer.data();
+    };
+    bool first = true;
+    auto writeLine = [&](uint64_t index) {
+        if (size_t(buffer.data() + buffer.size() - out) < maxLength + 1) {
+            flush();
+        }
+        if (!first) {
+            *out++ = '\n'; // newlines between insults, none after the last one
+        }
+        first = false;
+        out = writeInsult(out, index);
+    };
+
+    if (streamed) {
+        sampleIndicesInOrder(numInsults, combinationCount(), writeLine);
+    } else {
+        for (uint64_t index : indices) {
+            writeLine(index);
+        }
+    }
+    flush();
+
+    int closed = close(output.descriptor);
+    output.descriptor = -1;
+    if (closed != 0 || (replaced && rename(output.temporaryName.c_str(), fileName.c_str()) != 0)) {
 		throw FileException("Unable to write to " + fileName + "!");
 	}
+    output.temporaryName.clear(); // renamed, nothing left to remove
+}
+
+InsultBuffer::InsultBuffer() : offsets(1, 0) {}
+
+size_t InsultBuffer::size() const {
+    return offsets.size() - 1;
+}
+
+string_view InsultBuffer::operator[](size_t index) const {
+    return string_view(characters.data() + offsets[index], offsets[index + 1] - offsets[index] - 1);
+}
+
+string_view InsultBuffer::text() const {
+    return string_view(characters.data(), characters.size());
+}
+
+void InsultBuffer::clear() {
+    characters.clear();
+    offsets.assign(1, 0);
+}
+
+vector<uint64_t> InsultGenerator::sampleIndicesParallel(uint64_t count, uint64_t total, unsigned numThreads) {
+    if (issued != nullptr || columns[0].aliases != nullptr) {
+        return sampleIndices(count, total); // drawn on this thread, the strings are still built in parallel
+    }
+
+    // Each round draws as many indices as are still missing, in fixed size chunks that each have their
+    // own engine stream, and adds them to a shared set. The set after a round is the union of the draws,
+    // so it does not depend on which thread inserted first, and as no index is favoured every subset is
+    // equally likely. Sampling the complement of large requests keeps at least half of the space free,
+    // so each round fills at least half of what is missing on average.
+    const uint64_t chunkSize = 1 << 16; // draws per task
+    auto chunkStreams = [&](size_t numChunks) {
+        vector<Xoshiro256> streams(numChunks, Xoshiro256(engine()));
+        for (size_t i = 1; i < numChunks; i++) {
+            streams[i] = streams[i - 1];
+            streams[i].jump();
+        }
+        return streams;
+    };
+
+    if (total / 64 <= count) {
+        // dense request, the set is a bitset updated with atomic or, so inserts never take a lock
+        bool complement = count > total / 2;
+        uint64_t wanted = complement ? total - count : count;
+        vector<uint64_t> taken((total + 63) / 64);
+        uint64_t numTaken = 0;
+        while (numTaken < wanted) {
+            uint64_t missing = wanted - numTaken;
+            size_t numChunks = (missing + chunkSize - 1) / chunkSize;
+            vector<Xoshiro256> streams = chunkStreams(numChunks);
+            vector<uint64_t> added(numChunks);
+            runTasks(numChunks, numThreads, [&](size_t chunk) {
+                uint64_t numDraws = min(chunkSize, missing - chunk * chunkSize);
+                for (uint64_t i = 0; i < numDraws; i++) {
+                    uint64_t t = streams[chunk].bounded(total);
+                    uint64_t bit = uint64_t(1) << (t % 64);
+                    added[chunk] += (__atomic_fetch_or(&taken[t / 64], bit, __ATOMIC_RELAXED) & bit) == 0;
+                }
+            });
+            for (uint64_t numAdded : added) {
+                numTaken += numAdded;
+            }
+        }
+
+        // read the chosen indices back in order, counting each block first so blocks can be written in parallel
+        const size_t blockWords = 1 << 12;
+        size_t numBlocks = (taken.size() + blockWords - 1) / blockWords;
+        auto chosenBits = [&](size_t word) {
+            uint64_t bits = complement ? ~taken[word] : taken[word];
+            uint64_t used = total - word * 64; // bits past the end of the space are never chosen
+            return (used < 64) ? (bits & ((uint64_t(1) << used) - 1)) : bits;
+        };
+        vector<size_t> blockStart(numBlocks + 1);
+        runTasks(numBlocks, numThreads, [&](size_t block) {
+            size_t numChosen = 0;
+            for (size_t word = block * blockWords; word < min(taken.size(), (block + 1) * blockWords); word++) {
+                numChosen += __builtin_popcountll(chosenBits(word));
+            }
+            blockStart[block + 1] = numChosen;
+        });
+        for (size_t block = 0; block < numBlocks; block++) {
+            blockStart[block + 1] += blockStart[block];
+        }
+
+        vector<uint64_t> indices(count);
+        runTasks(numBlocks, numThreads, [&](size_t block) {
+            uint64_t *out = indices.data() + blockStart[block];
+            for (size_t word = block * blockWords; word < min(taken.size(), (block + 1) * blockWords); word++) {
+                for (uint64_t bits = chosenBits(word); bits != 0; bits &= bits - 1) {
+                    *out++ = word * 64 + __builtin_ctzll(bits);
+                }
+            }
+        });
+        return indices;
+    }
+
+    // sparse request, each chunk sorts its own draws and the sorted chunks are merged pairwise in parallel
+    vector<uint64_t> indices;
+    while (indices.size() < count) {
+        uint64_t missing = count - indices.size();
+        size_t numChunks = (missing + chunkSize - 1) / chunkSize;
+        vector<Xoshiro256> streams = chunkStreams(numChunks);
+        size_t numSorted = indices.size();
+        indices.resize(count);
+        runTasks(numChunks, numThreads, [&](size_t chunk) {
+            auto first = indices.begin() + numSorted + chunk * chunkSize;
+            auto last = first + min(chunkSize, missing - chunk * chunkSize);
+            for (auto draw = first; draw != last; ++draw) {
+                *draw = streams[chunk].bounded(total);
+            }
+            sort(first, last);
+        });
+
+        // runs[i] is where the i-th sorted run starts, the indices kept from earlier rounds form the first run
+        vector<size_t> runs;
+        if (numSorted > 0) {
+            runs.push_back(0);
+        }
+        for (size_t chunk = 0; chunk < numChunks; chunk++) {
+            runs.push_back(numSorted + chunk * chunkSize);
+        }
+        runs.push_back(count);
+        while (runs.size() > 2) {
+            size_t numMerges = (runs.size() - 1) / 2;
+            runTasks(numMerges, numThreads, [&](size_t merge) {
+                inplace_merge(indices.begin() + runs[2 * merge], indices.begin() + runs[2 * merge + 1], indices.begin() + runs[2 * merge + 2]);
+            });
+            vector<size_t> merged;
+            for (size_t i = 0; i < runs.size(); i += 2) {
+                merged.push_back(runs[i]);
+            }
+            if (merged.back() != count) {
+                merged.push_back(count);
+            }
+            runs.swap(merged);
+        }
+        indices.erase(unique(indices.begin(), indices.end()), indices.end());
+    }
+    return indices;
+}
+
+vector<string> InsultGenerator::generateParallel(int numInsults, unsigned numThreads) {
+    if (numInsults < 1 || uint64_t(numInsults) > combinationCount()) {
+		throw NumInsultsOutOfBounds("Invalid number of insults!");
+	}
+    if (numThreads == 0) {
+        numThreads = max(1u, thread::hardware_concurrency());
+    }
+
+    vector<uint64_t> indices = sampleIndicesParallel(numInsults, combinationCount(), numThreads);
+    vector<string> insultList(indices.size());
+    const size_t chunkSize = 1 << 14;
+    runTasks((indices.size() + chunkSize - 1) / chunkSize, numThreads, [&](size_t chunk) {
+        for (size_t i = chunk * chunkSize; i < min(indices.size(), (chunk + 1) * chunkSize); i++) {
+            insultList[i] = insultAt(indices[i]);
+        }
+    });
+
+    return insultList;
+}
+
+void InsultGenerator::generateParallel(int numInsults, InsultBuffer &insults, unsigned numThreads) {
+    if (numInsults < 1 || uint64_t(numInsults) > combinationCount()) {
+		throw NumInsultsOutOfBounds("Invalid number of insults!");
+	}
+    if (numThreads == 0) {
+        numThreads = max(1u, thread::hardware_concurrency());
+    }
+
+    vector<uint64_t> indices = sampleIndicesParallel(numInsults, combinationCount(), numThreads);
+    const size_t chunkSize = 1 << 14;
+    size_t numChunks = (indices.size() + chunkSize - 1) / chunkSize;
+
+    // exact offsets first, so that every chunk can write its insults straight to their final place
+    insults.clear();
+    insults.offsets.resize(indices.size() + 1);
+    runTasks(numChunks, numThreads, [&](size_t chunk) {
+        for (size_t i = chunk * chunkSize; i < min(indices.size(), (chunk + 1) * chunkSize); i++) {
+            insults.offsets[i + 1] = insultLength(indices[i]) + 1;
+        }
+    });
+    for (size_t i = 0; i < indices.size(); i++) {
+        insults.offsets[i + 1] += insults.offsets[i];
+    }
+
+    insults.characters.resize(insults.offsets.back());
+    runTasks(numChunks, numThreads, [&](size_t chunk) {
+        for (size_t i = chunk * chunkSize; i < min(indices.size(), (chunk + 1) * chunkSize); i++) {
+            char *out = writeInsult(insults.characters.data() + insults.offsets[i], indices[i]);
+            *out = '\n';
+        }
+    });
+}
+
+uint64_t InsultGenerator::permutedIndex(uint64_t n, uint64_t permutationSeed) const {
+    uint64_t total = combinationCount();
+    if (n >= total) {
+		throw NumInsultsOutOfBounds("Invalid insult number!");
+	}
+
+    // A balanced Feistel network over the smallest even number of bits that covers total is a
+    // bijection of [0, 4^halfBits). Applying it again until the result falls below total (cycle
+    // walking) gives a bijection of [0, total), and as 4^halfBits < 4 * total it takes fewer than
+    // four applications on average.
+    int bits = 64 - __builtin_clzll(max(total - 1, uint64_t(1)));
+    int halfBits = (bits + 1) / 2;
+    uint64_t mask = (uint64_t(1) << halfBits) - 1;
+
+    const int numRounds = 6;
+    uint64_t keys[numRounds];
+    for (int round = 0; round < numRounds; round++) {
+        keys[round] = mix64(permutationSeed + (round + 1) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    uint64_t index = n;
+    do {
+        uint64_t left = index >> halfBits;
+        uint64_t right = index & mask;
+        for (int round = 0; round < numRounds; round++) {
+            uint64_t next = left ^ (mix64(right ^ keys[round]) & mask);
+            left = right;
+            right = next;
+        }
+        index = (left << halfBits) | right;
+    } while (index >= total);
+    return index;
+}
+
+string InsultGenerator::permutedInsult(uint64_t n, uint64_t permutationSeed) const {
+    return insultAt(permutedIndex(n, permutationSeed));
+}
+
+void InsultGenerator::permutedInsults(uint64_t start, uint64_t end, uint64_t permutationSeed, InsultBuffer &insults) const {
+    if (start > end || end > combinationCount()) {
+		throw NumInsultsOutOfBounds("Invalid insult number!");
+	}
+
+    // size the buffer once for the longest possible insults, then trim it to what was written
+    insults.clear();
+    insults.characters.resize(size_t(end - start) * (maxLength + 1));
+    insults.offsets.reserve(size_t(end - start) + 1);
+    char *first = insults.characters.data();
+    char *out = first;
+    for (uint64_t n = start; n < end; n++) {
+        out = writeInsult(out, permutedIndex(n, permutationSeed));
+        *out++ = '\n';
+        insults.offsets.push_back(out - first);
+    }
+    insults.characters.resize(out - first);
+}
+
+MappedFile::MappedFile(const string &path) : data(nullptr), size(0) {
+    int descriptor = open(path.c_str(), O_RDONLY);
+
+    // throw exception if file cannot be opened
+    if (descriptor < 0) {
+        throw FileException("Unable to read " + path + "!");
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        throw FileException("Unable to read " + path + "!");
+    }
+
+    size = size_t(status.st_size);
+    if (size > 0) {
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data == MAP_FAILED) {
+            close(descriptor);
+            throw FileException("Unable to read " + path + "!");
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+    close(descriptor);
+}
 
-    // output insults to file line by line
-    for (int i = 0; i < (insultList.size() - 1); i++) {
-        file << insultList[i] << endl;
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(data, size);
     }
-    file << insultList[insultList.size() - 1]; // output the last insult without a newline character
+}
 
-    file.close();
+string_view MappedFile::contents() const {
+    return string_view(static_cast<const char *>(data), size);
 }
 
 FileException::FileException(const string& message) {
@@ -7,20 +7,133 @@ Description: Header file for a Shakespearian Insult Generator
 #pragma once
 
 #include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+
+#include "randomEngine.h"
 
 using namespace std;
 
+// many insults stored back to back in one character buffer, each followed by a newline, with an
+// offset table marking where each one starts. Reusing a buffer across calls reuses its storage.
+class InsultBuffer {
+public:
+    InsultBuffer(); // constructor, empty
+    size_t size() const; // number of insults
+    string_view operator[](size_t index) const; // insult without its newline
+    string_view text() const; // every insult, one per line
+    void clear(); // empties the buffer but keeps its storage
+
+private:
+    friend class InsultGenerator;
+
+    vector<char> characters; // insults, each followed by '\n'
+    vector<size_t> offsets; // insult i spans [offsets[i], offsets[i + 1] - 1), offsets[0] is 0
+};
+
+// read-only memory mapping of a whole file, unmapped when the object is destroyed
+class MappedFile {
+public:
+    MappedFile(const string &path); // constructor, throws FileException if the file cannot be mapped
+    ~MappedFile(); // destructor
+    MappedFile(const MappedFile &other) = delete;
+    MappedFile &operator=(const MappedFile &other) = delete;
+
+    string_view contents() const;
+
+private:
+    void *data; // start of the mapping, nullptr for an empty file
+    size_t size; // length of the file in bytes
+};
+
+// slot of an alias table, a draw that lands on the slot keeps its word if a random 64-bit value is
+// below threshold and takes word alias otherwise
+struct AliasEntry {
+    uint64_t threshold;
+    uint64_t alias;
+};
+
+// one column of a vocabulary, its words in alphabetical order
+struct VocabularyColumn {
+    const string_view *words;
+    uint64_t size; // number of words
+    uint64_t placeValue; // product of the sizes of the later columns, the weight of this column in a combination index
+    const double *weights; // relative weight of each word, nullptr if the words are equally likely
+    const AliasEntry *aliases; // alias table for drawing words by weight, nullptr if the words are equally likely
+};
+
+struct LoadedVocabulary; // a vocabulary read from a file, defined in insultGenerator.cpp
+class IssuedBitmap; // record of issued insults, defined in issuedBitmap.h
+
 class InsultGenerator {
 public:
-    InsultGenerator();
+    InsultGenerator(); // seeded from random_device, so every run differs
+    InsultGenerator(uint64_t seed); // seeded by the caller for reproducible runs
+    void seed(uint64_t seed); // restarts the random sequence
+    // loads InsultsSource.txt, or in builds with EMBEDDED_VOCABULARY selects the copy of it compiled
+    // into the binary, which reads no file, allocates nothing and cannot throw
     void initialize();
+
+    // loads a vocabulary of tab separated columns, one word per column per line. Columns may have
+    // different lengths, an insult takes one word from each column in order. In a weighted vocabulary
+    // every word cell is followed by a cell holding its weight, and words are drawn in proportion to
+    // their weights (words of weight 0 are left out).
+    void initialize(const string &fileName, bool weighted = false);
     string talkToMe();
-    vector<string> generate(int numInsults);
-    void generateAndSave(string fileName,int numInsults);
+    vector<string> generate(int numInsults); // unique insults in alphabetical order, 1 <= numInsults <= combinationCount()
+    void generate(int numInsults, InsultBuffer &insults); // same insults written into one buffer instead of separate strings
+    void generateAndSave(string fileName,int numInsults); // generate() streamed to a file, one insult per line, in constant memory, replacing fileName only on success
+
+    // generate() split across numThreads worker threads (0 for one per core), each drawing from its own
+    // stream. The result depends only on the seed, not on the thread count or scheduling.
+    vector<string> generateParallel(int numInsults, unsigned numThreads = 0);
+    void generateParallel(int numInsults, InsultBuffer &insults, unsigned numThreads = 0);
+    uint64_t combinationCount() const; // number of distinct insults
+
+    // Insult n, for 0 <= n < combinationCount(), of a pseudo-random ordering of every combination
+    // chosen by permutationSeed. Different n always give different insults, so workers sharing a
+    // seed can each produce a slice [start, end) with no shared state and no repeats between them.
+    // Words are equally likely here whether or not the vocabulary is weighted.
+    string permutedInsult(uint64_t n, uint64_t permutationSeed) const;
+    void permutedInsults(uint64_t start, uint64_t end, uint64_t permutationSeed, InsultBuffer &insults) const; // insults start ... end - 1 into one buffer
+
+    // Records every insult handed out in the bitmap file fileName, created if needed, so that
+    // talkToMe() and generate() never repeat an insult across runs or between processes sharing the
+    // file. Loading another vocabulary stops the tracking. Throws FileException if the vocabulary
+    // has more than 2^36 insults, whose bitmap would take over 8 GiB.
+    void trackIssued(const string &fileName);
+    void stopTrackingIssued();
+    uint64_t unissuedCount() const; // insults not handed out yet, all of them when not tracking
 
 private:
-    vector<string> column1, column2, column3;
-    int randInt();
+    shared_ptr<const LoadedVocabulary> vocabulary; // a loaded vocabulary, shared by copies of the generator, empty for the embedded one
+    const VocabularyColumn *columns; // columns of the vocabulary in use
+    size_t numColumns;
+    size_t maxLength; // maxInsultLength() of the loaded vocabulary
+    Xoshiro256 engine; // persistent engine shared by every draw
+    shared_ptr<IssuedBitmap> issued; // insults handed out so far, empty when not tracking
+    int randInt(int bound); // uniform in [0, bound)
+    uint64_t drawWord(const VocabularyColumn &column); // word of column, by weight if it has weights
+    uint64_t drawIndex(); // combination index of one word from each column, with repeats
+    uint64_t issueIndex(); // draws an insult not issued yet and marks it issued
+    bool tryIssueIndex(uint64_t &index); // issueIndex() by a bounded run of weighted draws, false if they only found issued insults
+    vector<uint64_t> issueWeighted(uint64_t count); // count insults not issued yet, drawn by weight in one pass over them and marked issued
+    vector<vector<double>> logWeights() const; // log of the weight of every word, by column
+    double drawKey(uint64_t index, const vector<vector<double>> &logWeights); // Efraimidis-Spirakis key of a combination, smaller for heavier ones
+    uint64_t vocabularyFingerprint() const; // hash of the words in use, ties a bitmap to its vocabulary
+    vector<uint64_t> sampleIndices(uint64_t count, uint64_t total); // count distinct indices in [0, total), ascending, by weight for a weighted vocabulary
+    vector<uint64_t> sampleIndicesParallel(uint64_t count, uint64_t total, unsigned numThreads); // sampleIndices() on worker threads
+    vector<uint64_t> sampleWeightedIndices(uint64_t count); // count distinct combination indices drawn by weight, ascending
+    vector<uint64_t> sampleUnissuedIndices(uint64_t count); // count indices not issued yet, marked issued, ascending
+    template <typename Emit>
+    void sampleIndicesInOrder(uint64_t count, uint64_t total, Emit emit); // calls emit for count distinct indices in [0, total), ascending, with constant memory
+    uint64_t permutedIndex(uint64_t n, uint64_t permutationSeed) const; // combination index of permutedInsult(n), constant time on average
+    string insultAt(uint64_t index) const; // insult for a combination index, indices follow alphabetical order
+    char *writeInsult(char *out, uint64_t index) const; // writes the insult for index and returns the end of it
+    size_t insultLength(uint64_t index) const; // length of the insult for index, without a newline
+    size_t maxInsultLength() const; // length of the longest possible insult
 };
 
 class FileException {
@@ -0,0 +1,311 @@
+/*
+File: insultServer.cpp
+Author: Logan Copeland
+Description: Insult Generator daemon serving requests over a Unix domain socket
+*/
+
+// Protocol: one request per line, "talk" or "generate n". Each answer is "OK k" followed by k
+// insults, one per line, or a single "ERR message" line. Clients may send any number of requests
+// without waiting, answers come back in request order.
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <charconv>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "insultGenerator.h"
+
+using namespace std;
+
+static volatile sig_atomic_t stopping = 0;
+
+static void requestStop(int) {
+    stopping = 1;
+}
+
+// one client, with the bytes read but not yet answered and the answers not yet written
+struct Connection {
+    int descriptor;
+    string input;
+    string output;
+    size_t outputSent = 0;
+    bool peerClosed = false; // the client sent everything it is going to send
+    uint32_t interest = EPOLLIN | EPOLLRDHUP; // events registered with epoll
+};
+
+class InsultServer {
+public:
+    InsultServer(const string &socketPath, InsultGenerator &generator);
+    ~InsultServer();
+    void run(); // serves until SIGINT or SIGTERM
+
+private:
+    static constexpr size_t readSize = 1 << 16;
+    static constexpr size_t outputLimit = 1 << 22; // answers held per connection before it stops reading
+
+    string socketPath;
+    InsultGenerator &generator;
+    InsultBuffer insults; // reused by every generate request
+    int listener;
+    int events;
+    unordered_map<int, unique_ptr<Connection>> connections;
+
+    void accept();
+    void handle(Connection &connection, uint32_t ready);
+    void answer(Connection &connection); // answers every complete request line while there is room
+    void answerLine(string_view line, string &output);
+    bool flush(Connection &connection); // writes what it can, false if the connection failed
+    void updateInterest(Connection &connection); // reads only while there is room for answers, writes only while some are waiting
+    void close(Connection &connection);
+};
+
+InsultServer::InsultServer(const string &socketPath, InsultGenerator &generator) : socketPath(socketPath), generator(generator) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.length() >= sizeof(address.sun_path)) {
+        throw FileException("Socket path " + socketPath + " is too long!");
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.length() + 1);
+
+    // a socket left behind by an earlier run is replaced, anything else at the path is left alone
+    struct stat status;
+    if (lstat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        unlink(socketPath.c_str());
+    }
+
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        if (listener >= 0) {
+            ::close(listener);
+        }
+        throw FileException("Unable to listen on " + socketPath + "!");
+    }
+
+    events = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listener;
+    if (events < 0 || epoll_ctl(events, EPOLL_CTL_ADD, listener, &event) != 0) {
+        if (events >= 0) {
+            ::close(events);
+        }
+        ::close(listener);
+        unlink(socketPath.c_str());
+        throw FileException("Unable to listen on " + socketPath + "!");
+    }
+}
+
+InsultServer::~InsultServer() {
+    for (auto &entry : connections) {
+        ::close(entry.first);
+    }
+    ::close(events);
+    ::close(listener);
+    unlink(socketPath.c_str());
+}
+
+void InsultServer::run() {
+    epoll_event ready[64];
+    while (!stopping) {
+        int numReady = epoll_wait(events, ready, 64, -1);
+        if (numReady < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw FileException(string("epoll_wait failed: ") + strerror(errno));
+        }
+        for (int i = 0; i < numReady; i++) {
+            if (ready[i].data.fd == listener) {
+                accept();
+                continue;
+            }
+            auto found = connections.find(ready[i].data.fd);
+            if (found != connections.end()) {
+                handle(*found->second, ready[i].events);
+            }
+        }
+    }
+}
+
+void InsultServer::accept() {
+    while (true) {
+        int descriptor = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (descriptor < 0) {
+            return; // EAGAIN once every pending connection is taken
+        }
+        unique_ptr<Connection> connection = make_unique<Connection>();
+        connection->descriptor = descriptor;
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = descriptor;
+        if (epoll_ctl(events, EPOLL_CTL_ADD, descriptor, &event) != 0) {
+            ::close(descriptor); // could not be watched, drop the client rather than never answer it
+            continue;
+        }
+        connections[descriptor] = move(connection);
+    }
+}
+
+void InsultServer::handle(Connection &connection, uint32_t ready) {
+    if (ready & EPOLLERR) {
+        close(connection);
+        return;
+    }
+
+    // drain the socket while there is room for the answers
+    if (!connection.peerClosed && (ready & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+        char block[readSize];
+        while (connection.output.size() - connection.outputSent < outputLimit) {
+            ssize_t received = read(connection.descriptor, block, sizeof(block));
+            if (received > 0) {
+                connection.input.append(block, received);
+            } else if (received == 0) {
+                connection.peerClosed = true;
+                break;
+            } else if (errno == EAGAIN) {
+                break;
+            } else if (errno != EINTR) {
+                close(connection);
+                return;
+            }
+        }
+    }
+
+    // answer every complete request, batching the answers into as few writes as the socket allows
+    while (true) {
+        answer(connection);
+        if (!flush(connection)) {
+            close(connection);
+            return;
+        }
+        if (!connection.output.empty() || connection.input.find('\n') == string::npos) {
+            break;
+        }
+    }
+    if (connection.peerClosed && connection.output.empty()) {
+        close(connection);
+        return;
+    }
+    updateInterest(connection);
+}
+
+void InsultServer::answer(Connection &connection) {
+    size_t start = 0;
+    while (connection.output.size() - connection.outputSent < outputLimit) {
+        size_t end = connection.input.find('\n', start);
+        if (end == string::npos) {
+            break;
+        }
+        answerLine(string_view(connection.input).substr(start, end - start), connection.output);
+        start = end + 1;
+    }
+    connection.input.erase(0, start);
+}
+
+void InsultServer::answerLine(string_view line, string &output) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    try {
+        if (line == "talk") {
+            output.append("OK 1\n").append(generator.talkToMe()).append("\n");
+            return;
+        }
+        int numInsults = 0;
+        string_view count = line.substr(min(line.length(), size_t(9)));
+        from_chars_result parsed = from_chars(count.data(), count.data() + count.length(), numInsults);
+        if (line.substr(0, 9) == "generate " && parsed.ec == errc() && parsed.ptr == count.data() + count.length()) {
+            generator.generate(numInsults, insults);
+            output.append("OK ").append(to_string(insults.size())).append("\n").append(insults.text());
+            return;
+        }
+        output.append("ERR Invalid request!\n");
+    } catch (NumInsultsOutOfBounds &e) {
+        output.append("ERR ").append(e.what()).append("\n");
+    }
+}
+
+bool InsultServer::flush(Connection &connection) {
+    while (connection.outputSent < connection.output.size()) {
+        ssize_t written = write(connection.descriptor, connection.output.data() + connection.outputSent, connection.output.size() - connection.outputSent);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0 && errno == EAGAIN) {
+            break;
+        }
+        if (written < 0) {
+            return false;
+        }
+        connection.outputSent += written;
+    }
+    if (connection.outputSent == connection.output.size()) {
+        connection.output.clear();
+        connection.outputSent = 0;
+    }
+    return true;
+}
+
+void InsultServer::updateInterest(Connection &connection) {
+    uint32_t interest = 0;
+    if (!connection.peerClosed && connection.output.size() - connection.outputSent < outputLimit) {
+        interest |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (!connection.output.empty()) {
+        interest |= EPOLLOUT;
+    }
+    if (interest != connection.interest) {
+        epoll_event event = {};
+        event.events = interest;
+        event.data.fd = connection.descriptor;
+        epoll_ctl(events, EPOLL_CTL_MOD, connection.descriptor, &event);
+        connection.interest = interest;
+    }
+}
+
+void InsultServer::close(Connection &connection) {
+    int descriptor = connection.descriptor;
+    epoll_ctl(events, EPOLL_CTL_DEL, descriptor, nullptr);
+    ::close(descriptor);
+    connections.erase(descriptor);
+}
+
+int main(int argc, char *argv[]) {
+    // optional arguments: socket path and vocabulary file
+    string socketPath = (argc > 1) ? argv[1] : "insultGenerator.sock";
+
+    struct sigaction action = {};
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    try {
+        InsultGenerator generator;
+        if (argc > 2) {
+            generator.initialize(argv[2]);
+        } else {
+            generator.initialize();
+        }
+        InsultServer server(socketPath, generator);
+        cerr << "Serving " << generator.combinationCount() << " insults on " << socketPath << endl;
+        server.run();
+    } catch (FileException &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
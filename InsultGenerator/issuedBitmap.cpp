@@ -0,0 +1,225 @@
+/*
+File: issuedBitmap.cpp
+Author: Logan Copeland
+Description: Implementation file for the memory-mapped record of issued insults
+*/
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "issuedBitmap.h"
+
+using namespace std;
+
+static const char bitmapMagic[8] = {'I', 'N', 'S', 'U', 'L', 'T', 'B', '1'};
+
+IssuedBitmap::IssuedBitmap(const string &fileName, uint64_t size, uint64_t fingerprint) : mapping(nullptr), mappingSize(0) {
+    // file layout: header, superblock counts, block counts, bits
+    numWords = (size + 63) / 64;
+    numBlocks = (size + blockBits - 1) / blockBits;
+    numSupers = (size + superBits - 1) / superBits;
+    size_t superOffset = 64;
+    size_t blockOffset = superOffset + numSupers * sizeof(uint64_t);
+    size_t wordOffset = blockOffset + (numBlocks * sizeof(uint32_t) + 7) / 8 * 8;
+    mappingSize = wordOffset + numWords * sizeof(uint64_t);
+
+    descriptor = open(fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    // throw exception if file cannot be opened
+    if (descriptor < 0) {
+        throw FileException("Unable to open " + fileName + "!");
+    }
+
+    // Every user holds a shared lock for as long as it has the file open. An exclusive lock is only
+    // granted when nobody else has the file, and then the file is set up or checked, and its counts
+    // rebuilt, before it is downgraded, so a second process never sees half a header.
+    auto fail = [&](const string &message) {
+        if (mapping != nullptr) {
+            munmap(mapping, mappingSize);
+        }
+        close(descriptor);
+        throw FileException(message);
+    };
+    bool exclusive = flock(descriptor, LOCK_EX | LOCK_NB) == 0;
+    struct stat status;
+    if ((!exclusive && (errno != EWOULDBLOCK || flock(descriptor, LOCK_SH) != 0)) || fstat(descriptor, &status) != 0) {
+        fail("Unable to open " + fileName + "!");
+    }
+    bool created = status.st_size == 0;
+    if (created && (!exclusive || ftruncate(descriptor, off_t(mappingSize)) != 0)) {
+        fail("Unable to open " + fileName + "!");
+    }
+    if (!created && size_t(status.st_size) != mappingSize) {
+        fail("Issued bitmap " + fileName + " does not match the vocabulary!");
+    }
+
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        fail("Unable to open " + fileName + "!");
+    }
+    char *base = static_cast<char *>(mapping);
+    header = reinterpret_cast<Header *>(base);
+    superIssued = reinterpret_cast<uint64_t *>(base + superOffset);
+    blockIssued = reinterpret_cast<uint32_t *>(base + blockOffset);
+    words = reinterpret_cast<uint64_t *>(base + wordOffset);
+
+    // a new file is all zeros, only the header needs writing
+    if (created) {
+        memcpy(header->magic, bitmapMagic, sizeof(bitmapMagic));
+        header->size = size;
+        header->fingerprint = fingerprint;
+    } else if (memcmp(header->magic, bitmapMagic, sizeof(bitmapMagic)) != 0 || header->size != size || header->fingerprint != fingerprint) {
+        fail("Issued bitmap " + fileName + " does not match the vocabulary!");
+    } else if (exclusive) {
+        rebuildCounts();
+    }
+    if (exclusive && flock(descriptor, LOCK_SH) != 0) {
+        fail("Unable to open " + fileName + "!");
+    }
+}
+
+IssuedBitmap::~IssuedBitmap() {
+    munmap(mapping, mappingSize);
+    close(descriptor); // releases the shared lock
+}
+
+uint64_t IssuedBitmap::size() const {
+    return header->size;
+}
+
+uint64_t IssuedBitmap::unissuedCount() const {
+    return size() - min(size(), __atomic_load_n(&header->issued, __ATOMIC_RELAXED));
+}
+
+bool IssuedBitmap::isIssued(uint64_t index) const {
+    return (__atomic_load_n(&words[index / 64], __ATOMIC_RELAXED) >> (index % 64)) & 1;
+}
+
+bool IssuedBitmap::issue(uint64_t index) {
+    uint64_t bit = uint64_t(1) << (index % 64);
+    if (__atomic_fetch_or(&words[index / 64], bit, __ATOMIC_RELAXED) & bit) {
+        return false;
+    }
+
+    // the counts follow the bit, so they never claim more issued indices than the bits hold
+    __atomic_fetch_add(&blockIssued[index / blockBits], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&superIssued[index / superBits], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&header->issued, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+uint64_t IssuedBitmap::issueRandom(Xoshiro256 &engine) {
+    // another process can take the drawn index first, then draw again
+    while (true) {
+        uint64_t index = (unissuedCount() == 0) ? size() : drawUnissued(engine);
+        if (index == size()) {
+            throw NumInsultsOutOfBounds("Every insult has been issued!");
+        }
+        if (issue(index)) {
+            return index;
+        }
+    }
+}
+
+void IssuedBitmap::rebuildCounts() {
+    // a process that died between setting a bit and counting it left the counts short, the bits
+    // themselves are always right
+    uint64_t total = 0;
+    fill(superIssued, superIssued + numSupers, 0);
+    for (uint64_t block = 0; block < numBlocks; block++) {
+        uint32_t count = 0;
+        for (uint64_t word = block * (blockBits / 64); word < min(numWords, (block + 1) * (blockBits / 64)); word++) {
+            count += __builtin_popcountll(words[word]);
+        }
+        blockIssued[block] = count;
+        superIssued[block / (superBits / blockBits)] += count;
+        total += count;
+    }
+    header->issued = total;
+}
+
+uint64_t IssuedBitmap::unissuedBits(uint64_t word) const {
+    uint64_t bits = ~__atomic_load_n(&words[word], __ATOMIC_RELAXED);
+    uint64_t used = size() - word * 64;
+    return (used < 64) ? (bits & ((uint64_t(1) << used) - 1)) : bits;
+}
+
+uint64_t IssuedBitmap::drawUnissued(Xoshiro256 &engine) const {
+    // while at least 1/16 of the space is free, a few random bit tests find a free index
+    uint64_t free = unissuedCount();
+    if (free >= size() / 16) {
+        for (int attempt = 0; attempt < 64; attempt++) {
+            uint64_t candidate = engine.bounded(size());
+            if (!isIssued(candidate)) {
+                return candidate;
+            }
+        }
+    }
+
+    // otherwise take the rank-th free index, following the counts down to a single word
+    uint64_t rank = engine.bounded(free);
+    uint64_t super = 0;
+    for (; super < numSupers; super++) {
+        uint64_t bits = min(superBits, size() - super * superBits);
+        uint64_t freeHere = bits - min(bits, uint64_t(__atomic_load_n(&superIssued[super], __ATOMIC_RELAXED)));
+        if (rank < freeHere) {
+            break;
+        }
+        rank -= freeHere;
+    }
+    uint64_t block = super * (superBits / blockBits);
+    for (; block < min(numBlocks, (super + 1) * (superBits / blockBits)); block++) {
+        uint64_t bits = min(blockBits, size() - block * blockBits);
+        uint64_t freeHere = bits - min(bits, uint64_t(__atomic_load_n(&blockIssued[block], __ATOMIC_RELAXED)));
+        if (rank < freeHere) {
+            break;
+        }
+        rank -= freeHere;
+    }
+    for (uint64_t word = block * (blockBits / 64); word < min(numWords, (block + 1) * (blockBits / 64)); word++) {
+        uint64_t bits = unissuedBits(word);
+        uint64_t freeHere = __builtin_popcountll(bits);
+        if (rank < freeHere) {
+            for (; rank > 0; rank--) {
+                bits &= bits - 1;
+            }
+            return word * 64 + __builtin_ctzll(bits);
+        }
+        rank -= freeHere;
+    }
+
+    // the counts lag behind bits that another process is setting right now
+    return nextUnissued(engine.bounded(size()));
+}
+
+uint64_t IssuedBitmap::nextUnissued(uint64_t start) const {
+    const uint64_t wordsPerBlock = blockBits / 64;
+    uint64_t word = start / 64;
+    uint64_t bits = unissuedBits(word) & (~uint64_t(0) << (start % 64));
+    for (uint64_t visited = 0; visited <= numWords; visited++) {
+        if (bits != 0) {
+            return word * 64 + __builtin_ctzll(bits);
+        }
+        word = (word + 1 == numWords) ? 0 : word + 1;
+
+        // a block whose count says it is full is full, skip it without reading its bits
+        uint64_t block = word / wordsPerBlock;
+        if (word % wordsPerBlock == 0 && __atomic_load_n(&blockIssued[block], __ATOMIC_RELAXED) >= min(blockBits, size() - block * blockBits)) {
+            uint64_t skipped = min(wordsPerBlock, numWords - word) - 1;
+            word += skipped;
+            visited += skipped;
+            bits = 0;
+            continue;
+        }
+        bits = unissuedBits(word);
+    }
+    return size();
+}
@@ -0,0 +1,67 @@
+/*
+File: issuedBitmap.h
+Author: Logan Copeland
+Description: Memory-mapped record of which insults have already been handed out
+*/
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "insultGenerator.h"
+#include "randomEngine.h"
+
+using namespace std;
+
+// One bit per combination index in a file shared by every run and process using it, plus counts of
+// issued bits per block of 4096 and per superblock of 2^24 bits so that free indices can be found
+// without scanning the whole bitmap. Bits are set with atomic operations on the shared mapping, so
+// two processes can never both issue the same index. A process killed between setting a bit and
+// counting it leaves the counts short, they are rebuilt from the bits whenever the file is opened
+// while no other process has it open.
+class IssuedBitmap {
+public:
+    // opens fileName, creating it if needed, for a space of size indices. Throws FileException if the
+    // file cannot be mapped or was made for a different size or vocabulary fingerprint.
+    IssuedBitmap(const string &fileName, uint64_t size, uint64_t fingerprint);
+    ~IssuedBitmap(); // destructor
+    IssuedBitmap(const IssuedBitmap &other) = delete;
+    IssuedBitmap &operator=(const IssuedBitmap &other) = delete;
+
+    uint64_t size() const; // number of indices
+    uint64_t unissuedCount() const; // indices not issued yet
+    bool isIssued(uint64_t index) const;
+    bool issue(uint64_t index); // marks index as issued, false if it already was
+
+    // issues an index chosen uniformly among those not issued yet and returns it. Throws
+    // NumInsultsOutOfBounds if every index has been issued.
+    uint64_t issueRandom(Xoshiro256 &engine);
+    uint64_t nextUnissued(uint64_t start) const; // first free index from start < size() on, wrapping around, size() if none
+
+private:
+    struct Header {
+        char magic[8];
+        uint64_t size;
+        uint64_t fingerprint;
+        uint64_t issued; // number of issued indices
+    };
+
+    static constexpr uint64_t blockBits = uint64_t(1) << 12;
+    static constexpr uint64_t superBits = uint64_t(1) << 24;
+
+    int descriptor; // kept open with a shared lock while mapped
+    void *mapping;
+    size_t mappingSize;
+    Header *header;
+    uint64_t *superIssued; // issued indices in each superblock
+    uint32_t *blockIssued; // issued indices in each block
+    uint64_t *words; // the bits, index i is bit i % 64 of words[i / 64]
+    uint64_t numWords;
+    uint64_t numBlocks;
+    uint64_t numSupers;
+
+    void rebuildCounts(); // recounts every block, superblock and the total from the bits, needs the file to itself
+    uint64_t drawUnissued(Xoshiro256 &engine) const; // uniform among the indices that looked free when drawn
+    uint64_t unissuedBits(uint64_t word) const; // free bits of words[word], without bits past the end
+};
@@ -0,0 +1,99 @@
+/*
+File: randomEngine.h
+Author: Logan Copeland
+Description: Small fast pseudo-random number engine used by the Insult Generator
+*/
+
+#pragma once
+
+#include <cstdint>
+
+using namespace std;
+
+// xoshiro256** by Blackman and Vigna: 256 bits of state, a period of 2^256 - 1 and a few
+// cycles per draw. Usable anywhere a standard UniformRandomBitGenerator is expected.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    Xoshiro256(uint64_t seed = 0) {
+        this->seed(seed);
+    }
+
+    // expands a 64-bit seed into the full state with splitmix64, so similar seeds give unrelated streams
+    void seed(uint64_t seed) {
+        for (uint64_t &word : state) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t mixed = seed;
+            mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+            word = mixed ^ (mixed >> 31);
+        }
+    }
+
+    uint64_t operator()() {
+        uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        uint64_t shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = rotateLeft(state[3], 45);
+        return result;
+    }
+
+    // uniform value in [0, bound) without modulo bias using Lemire's multiply and reject method,
+    // which only divides in the rare case that a draw lands in the biased region
+    uint64_t bounded(uint64_t bound) {
+        unsigned __int128 product = (unsigned __int128)(*this)() * bound;
+        uint64_t low = uint64_t(product);
+        if (low < bound) {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                product = (unsigned __int128)(*this)() * bound;
+                low = uint64_t(product);
+            }
+        }
+        return uint64_t(product >> 64);
+    }
+
+    // uniform double in (0, 1], never 0 so that its logarithm is finite
+    double uniform() {
+        return double(((*this)() >> 11) + 1) * 0x1p-53;
+    }
+
+    // advances the state by 2^128 draws, so repeated jumps split one seed into non-overlapping streams
+    void jump() {
+        static const uint64_t polynomial[4] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+        uint64_t jumped[4] = {0, 0, 0, 0};
+        for (uint64_t word : polynomial) {
+            for (int bit = 0; bit < 64; bit++) {
+                if (word & (uint64_t(1) << bit)) {
+                    for (int i = 0; i < 4; i++) {
+                        jumped[i] ^= state[i];
+                    }
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            state[i] = jumped[i];
+        }
+    }
+
+    static constexpr uint64_t min() {
+        return 0;
+    }
+
+    static constexpr uint64_t max() {
+        return UINT64_MAX;
+    }
+
+private:
+    uint64_t state[4];
+
+    static uint64_t rotateLeft(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+};